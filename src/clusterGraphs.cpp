@@ -0,0 +1,183 @@
+#include "clusterGraphs.hpp"
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <odsg/GraphSnapshot.hpp>
+#include <odsg/utils/strings.hpp>
+
+namespace bio_odsg {
+
+
+namespace {     // Put here general, global definitions limited to this file
+
+    /*
+     * Interning of the ids of the adjacency as proteins. The mapping is looked up by name only the first time that
+     * an id is seen; from there on, the id is resolved by an integer cache.
+     */
+    class ProteinInterner {
+    public:
+        explicit ProteinInterner(ProteinsMap& mapping): mapping(mapping), cache(), nextProteinId(1) {
+            for (ProteinsMap::const_iterator it = mapping.begin(); it != mapping.end(); ++it) {
+                if (it->second >= nextProteinId)
+                    nextProteinId = it->second + 1;
+            }
+        }
+
+        template<typename IdT>
+        ProteinId operator()(IdT id) {
+            std::unordered_map<long long int, ProteinId>::const_iterator cached = cache.find(id);
+            if (cached != cache.end())
+                return cached->second;
+
+            // Same name that the id got in the clusters.txt file
+            ProteinName name = odsg::strings::to_str(id);
+            ProteinsMap::const_iterator it = mapping.find(name);
+            if (it == mapping.end())
+                it = mapping.insert(std::make_pair(name, nextProteinId++)).first;
+
+            cache.insert(std::make_pair(static_cast<long long int>(id), it->second));
+            return it->second;
+        }
+
+    private:
+        ProteinsMap& mapping;
+        std::unordered_map<long long int, ProteinId> cache;
+        ProteinId nextProteinId;
+    };
+
+
+    const char GRAPHS_COUNT_LINE[] = "# graphs";      // Header of the mapping file of the snapshots
+
+    inline std::string
+    snapshotFileName(const std::string& prefix, std::size_t i) {
+        return prefix + "." + odsg::strings::to_str(i) + ".snap";
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<odsg::WGraph>
+buildClustersWGraphs(const std::vector<std::vector<int> >& clusters,
+                     const minhash::Adjacency& adjacency,
+                     ProteinsMap& mapping,
+                     std::ostream* dump) {
+
+    std::map<ProteinId, std::set<ProteinId> > dataset;
+    odsg::UndirectedWedgeMap ppi_dataset;
+    std::vector<odsg::WGraph> Clusters;
+
+    ProteinInterner intern(mapping);
+
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+        bool closed = true;
+
+        for (std::size_t j = 0; j < clusters[i].size(); ++j) {
+            int node = clusters[i][j];
+            std::size_t row = static_cast<std::size_t>(node);      // Row r of the dataset is the list of vertex r
+            assert(row < adjacency.rowsCount());
+
+            if (adjacency.degree(row) < 3)
+                closed = false;     // Minimum size considered by the original algorithm
+
+            ProteinId left_vertex = intern(node);
+            const minhash::Weight* weight = adjacency.isWeighted() ? adjacency.rowWeights(row) : NULL;
+            bool selfLoop = false;
+            for (const minhash::Id* it = adjacency.row(row); it != adjacency.rowEnd(row); ++it) {
+                if (static_cast<minhash::Id>(node) == *it)
+                    selfLoop = true;
+
+                float value = weight ? *weight++ : 1.0f;
+                ProteinId right_vertex = intern(*it);
+                dataset[left_vertex].insert(right_vertex);
+                dataset[right_vertex].insert(left_vertex);
+                ppi_dataset.add_edge(left_vertex, right_vertex, value);
+
+                if (dump)
+                    *dump << node << ' ' << *it << ' ' << value << '\n';
+            }
+            if (!selfLoop) {
+                dataset[left_vertex].insert(left_vertex);
+                ppi_dataset.add_edge(left_vertex, left_vertex, 1.0);
+
+                if (dump)
+                    *dump << node << ' ' << node << ' ' << 1.0 << '\n';
+            }
+        }
+
+        if (closed) {
+            Clusters.push_back(odsg::WGraph(dataset, ppi_dataset));
+            dataset.clear();
+            ppi_dataset = odsg::UndirectedWedgeMap();
+
+            if (dump)
+                *dump << "#\n";
+        }
+    }
+    return Clusters;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+writeClustersSnapshots(const std::string& prefix,
+                       const std::vector<odsg::WGraph>& graphs,
+                       const ProteinsMap& mapping) {
+
+    std::ofstream outfile((prefix + ".mapping").c_str());
+    if (!outfile) {
+        throw std::runtime_error("writeClustersSnapshots(): can not open output mapping file");
+    }
+    outfile << GRAPHS_COUNT_LINE << ' ' << graphs.size() << '\n';
+    for (ProteinsMap::const_iterator it = mapping.begin(); it != mapping.end(); ++it) {
+        outfile << it->first << ' ' << it->second << '\n';
+    }
+    if (!outfile.flush()) {
+        throw std::runtime_error("writeClustersSnapshots(): can not write output mapping file");
+    }
+
+    for (std::size_t i = 0; i < graphs.size(); ++i) {
+        odsg::GraphSnapshot::write(graphs[i], snapshotFileName(prefix, i));
+    }
+}
+
+
+std::vector<odsg::WGraph>
+readClustersSnapshots(const std::string& prefix, ProteinsMap& mapping) {
+
+    std::ifstream infile((prefix + ".mapping").c_str());
+    if (!infile) {
+        throw std::runtime_error("readClustersSnapshots(): can not open input mapping file");
+    }
+
+    std::string line;
+    std::size_t graphsCount = 0;
+    if (!std::getline(infile, line) || line.compare(0, sizeof(GRAPHS_COUNT_LINE) - 1, GRAPHS_COUNT_LINE) != 0
+        || !(std::istringstream(line.substr(sizeof(GRAPHS_COUNT_LINE) - 1)) >> graphsCount)) {
+        throw std::runtime_error("readClustersSnapshots(): not a mapping file of snapshots");
+    }
+
+    mapping.clear();
+    while (std::getline(infile, line)) {
+        std::istringstream iss(line);
+        ProteinName protein;
+        ProteinId id;
+        if (!(iss >> protein >> id)) {
+            throw std::runtime_error("readClustersSnapshots(): bad line format");
+        }
+        mapping.insert(mapping.end(), std::make_pair(protein, id));     // Written sorted by name
+    }
+
+    std::vector<odsg::WGraph> graphs(graphsCount);
+    for (std::size_t i = 0; i < graphsCount; ++i) {
+        odsg::GraphSnapshot(snapshotFileName(prefix, i)).load(graphs[i]);
+    }
+    return graphs;
+}
+
+}   // namespace bio_odsg
@@ -0,0 +1,58 @@
+#ifndef BIO_CLUSTER_GRAPHS_HPP_INCLUDED
+#define BIO_CLUSTER_GRAPHS_HPP_INCLUDED
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <odsg/WGraph.hpp>
+
+#include "minhash/adjacency.hpp"
+#include "typedefs.hpp"
+
+
+namespace bio_odsg {
+
+/*
+ * Build one graph by cluster found by minhash::min(), straight from its clusters and the adjacency lists of the
+ * dataset: no intermediate file is written nor parsed.
+ *
+ * Each member of a cluster contributes all the interactions of its adjacency list, plus a self loop. The interactions
+ * weigh as given in the adjacency if it's weighted (see minhash::Parameters), or 1.0, like the self loops. Members are given as 0-based rows of the adjacency, as minhash::min() returns them, and
+ * the row r is the adjacency list of the vertex r; every id is taken as the name of a protein, as
+ * readDatasetFromFileWW() did when reading the old clusters.txt file. That includes its quirk: a cluster with some
+ * member of less than 3 neighbors isn't closed, and its interactions are carried over to the next cluster (those
+ * after the last closed cluster are dropped).
+ *
+ * Returns the graphs, and the mapping updated with all the new proteins seen in the clusters. If dump is given,
+ * the clusters are written there in the clusters.txt format too, for debugging.
+ */
+std::vector<odsg::WGraph>
+buildClustersWGraphs(const std::vector<std::vector<int> >& clusters,
+                     const minhash::Adjacency& adjacency,
+                     ProteinsMap& mapping,              // Out-parameter
+                     std::ostream* dump=NULL);
+
+
+/*
+ * Save the graphs of the clusters, usually already rebuilt for mining, so that later runs can mine them again without
+ * clustering the dataset. Each graph is written with its weights to its own snapshot file (see odsg::GraphSnapshot),
+ * named prefix + ".<i>.snap" for the i-th graph; the mapping is written to prefix + ".mapping", in the format read by
+ * readDatasetMappingFromFile(), after a comment line with the number of graphs. It can throw an exception.
+ */
+void
+writeClustersSnapshots(const std::string& prefix,
+                       const std::vector<odsg::WGraph>& graphs,
+                       const ProteinsMap& mapping);
+
+/*
+ * Load the graphs and the mapping saved by writeClustersSnapshots(). Unlike readDatasetMappingFromFile(), the
+ * mapping isn't checked for duplicates, so it's read in linear time. It can throw an exception.
+ */
+std::vector<odsg::WGraph>
+readClustersSnapshots(const std::string& prefix,
+                      ProteinsMap& mapping);            // Out-parameter
+
+
+}       // namespace bio_odsg
+#endif  // BIO_CLUSTER_GRAPHS_HPP_INCLUDED
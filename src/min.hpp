@@ -1,113 +1,240 @@
 #ifndef MINHASH_TEST
 #define MINHASH_TEST
 
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <limits.h>
-#include <map>
-#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <odsg/utils/io.hpp>
+#include <odsg/utils/parallel.hpp>
+
+#include "minhash/adjacency.hpp"
+#include "minhash/banding.hpp"
+#include "minhash/onePermutation.hpp"
+#include "minhash/signatureMatrix.hpp"
+#include "minhash/signatures.hpp"
+#include "minhash/weighted.hpp"
+
 namespace minhash{
-  std::vector<std::vector<long long int> > graph;
 
-  unsigned hash_str(std::string s, int F, int A, int B) {
-    unsigned h = F;
-    for (int i = 0; i < s.size(); ++i) {
-      h = (h * A) ^ (s[i] * B);
+  /*
+   * Knobs of the clustering by MinHash. Rows are clustered by LSH banding: bands * rowsPerBand signatures are
+   * computed by row, and two rows share a cluster when all the signatures of a same band match.
+   * The defaults (2 bands of 1 signature) keep the two signatures by row of the classic setup, but not exactly its
+   * clusters: see BandTables for the differences.
+   *
+   * With onePermutation, all the signatures of a row are computed with a single hash by shingle (see
+   * OnePermutationEngine), so raising the number of signatures doesn't multiply the cost of signing.
+   *
+   * With weighted, each row alternates neighbor ids and the weights of their interactions ("id weight id weight..."),
+   * and the signatures are weighted MinHash ones (see WeightedSignatureEngine): rows are clustered by their weighted
+   * Jaccard similarity. A last id without weight weighs 1.0. The weights are kept in the adjacency lists of the
+   * result. It can't be combined with onePermutation.
+   *
+   * With signatureBits below 32 (8 or 16), the signatures of all the rows are kept in a SignatureMatrix, truncated to
+   * that number of bits, and banded only at the end; it takes less memory than the band tables when there are many
+   * signatures by row. The rows of each cluster must be linked by pairs with a corrected similarity above
+   * minSimilarity (see SignatureMatrix::clusters()); with 8 bits, rowsPerBand must be above 1. Linking the rows of
+   * a bucket compares them by pairs until they are all linked, so a bucket of n rows takes up to n * (n - 1) / 2
+   * similarities (of all the signatures of both rows) when they are dissimilar, and about n when they are near
+   * duplicates; with 16 bits and few signatures by band, the buckets can be big.
+   *
+   * The input is parsed and signed by chunks of lines in a pool of threads; the clusters are the same whatever the
+   * number of threads.
+   */
+  struct Parameters {
+    unsigned int bands;
+    unsigned int rowsPerBand;
+    uint64_t seed;
+    bool onePermutation;
+    bool weighted;
+    unsigned int signatureBits;
+    double minSimilarity;
+    unsigned int threads;
+
+    Parameters(): bands(2), rowsPerBand(1), seed(DEFAULT_SEED), onePermutation(false), weighted(false),
+                  signatureBits(32), minSimilarity(0.0), threads(1) {}
+
+    unsigned int signaturesCount() const { return bands * rowsPerBand; }
+    bool bBit() const { return signatureBits < 32; }
+  };
+
+  namespace detail {
+
+    /*
+     * A range of consecutive lines of the input, parsed and signed by a single task. Its rows are numbered from
+     * 0; they get their global index when the chunks are merged, in order.
+     *
+     * The rows are parsed only once, straight into the CSR layout of the result; the signatures are computed from
+     * there too, and kept in the band tables or, for b-bit signatures, in the signature matrix.
+     */
+    struct Chunk {
+      Adjacency rows;
+      BandTables tables;
+      SignatureMatrix matrix;
+      bool bBit;
+
+      explicit Chunk(const Parameters& params): rows(), tables(params.bands, params.rowsPerBand),
+                                                matrix(params.signaturesCount(), params.signatureBits),
+                                                bBit(params.bBit()) {}
+
+      void insert(int row, const Signature* signatures) {
+        if (bBit)
+          matrix.insert(row, signatures);
+        else
+          tables.insert(row, signatures);
+      }
+    };
+
+    /*
+     * Neighbor ids are kept and hashed as 32-bit integers, so an id out of 0..2^32-2 is rejected instead of wrapped
+     * around into another one; the greatest 32-bit value is left out so that one past any id still fits.
+     */
+    inline Id toId(long long int d) {
+      if (d < 0 || d > static_cast<long long int>(UINT_MAX) - 1)
+        throw std::invalid_argument("minhash::min(): neighbor id out of the range of 32-bit ids: " + std::to_string(d));
+      return static_cast<Id>(d);
     }
-    return h; // or return h % C;
-  }
 
-  std::vector<std::vector<int>> min(std::string input) {
-    const char * c = input.c_str();
-    std::ifstream myfile;
-    myfile.open(c);
-
-    std::map<long long int, int> mp;
-    long long int v, a;
-    std::string list;
-    long long int l = 0;
-    int P = 2;
-    //myfile >> v;
-    std::vector<std::vector<long long int> > arr;
-    // std::cout << arr.size() << '\n';
-    while (getline(myfile, list)) {
-      // std::cout<<list<<'\n';
-      long long int d, c_j = INT_MAX;
-      std::vector<long long int> row;
-      std::stringstream lineStream(list);
-
-      while (lineStream >> d)
-        row.push_back(d);
-
-      std::vector<std::string> ladj;
-      for (int i = 0; i < row.size(); ++i) {
-        std::string aux = std::to_string(row[i]);
-        ladj.push_back(aux);
-        // std::cout<<aux<<'\n';
-      } // std::cout<<'\n';
-      std::vector<long long int> hashes;
-      for (int i = 0; i < P; ++i) {
-        if (ladj.size() >= 2) {
-          for (int j = 0; j < ladj.size() - 1; ++j) {
-            std::string shingle;
-            // std::cout<<ladj[j]<<' '<<ladj[j+1]<<'\n';
-            shingle.append(ladj[j]);
-            shingle.append(ladj[j + 1]);
-            long long int h;
-            if (i == 0)
-              h = hash_str(shingle, 59, 7, 13);
-            if (i == 1)
-              h = hash_str(shingle, 81, 7, 17);
-            // if(i == 2) h = hash_str(shingle,83,7,27);//Hash of the 2-shingle
-            c_j = std::min(
-                h, c_j); // Choose the min between the new hash and the older one
-          }
-        }
-        hashes.push_back(c_j);
-        if (c_j != INT_MAX)
-          mp[c_j]++;
+    template<typename EngineT>
+    inline void parseAndSign(const char* first, const char* last, const EngineT& engine, Chunk& chunk) {
+      std::vector<Signature> hashes(engine.size());
+
+      // Same as reading with getline: a final line without '\n' counts too, but not an empty one after the last '\n'
+      while (first < last) {
+        const char* eol = odsg::io::end_of_line(first, last);
+
+        // Same as reading with >> from the line: the parsing of a row stops at the first thing that isn't a number
+        for (long long int d; odsg::io::parse_integer(first, eol, d); )
+          chunk.rows.addNeighbor(toId(d));
+        chunk.rows.closeRow();
+
+        // The 2-shingles (row[j], row[j + 1]) are hashed directly as integers
+        std::size_t r = chunk.rows.rowsCount() - 1;
+        engine.sign(chunk.rows.row(r), chunk.rows.rowEnd(r), hashes.data());
+        chunk.insert(static_cast<int>(r), hashes.data());
+
+        first = eol + 1;
       }
-      arr.push_back(hashes);
-      graph.push_back(row);
-      l++;
     }
-    /*for (int i = 0; i < arr.size(); i++) {
-      for (int j = 0; j < P; j++) {
-        std::cout << arr[i][j] << "    ";
+
+    inline void parseAndSignWeighted(const char* first, const char* last, const WeightedSignatureEngine& engine,
+                                     Chunk& chunk) {
+      std::vector<Signature> hashes(engine.size());
+
+      while (first < last) {
+        const char* eol = odsg::io::end_of_line(first, last);
+
+        // The weights are kept with the rows, so the graphs of the clusters get them too
+        long long int d;
+        for (double w; odsg::io::parse_integer(first, eol, d); ) {
+          Weight weight = odsg::io::parse_real(first, eol, w) ? static_cast<Weight>(w) : Weight(1.0);
+          chunk.rows.addNeighbor(toId(d), weight);
+        }
+        chunk.rows.closeRow();
+
+        std::size_t r = chunk.rows.rowsCount() - 1;
+        const Weight* weights = chunk.rows.isWeighted() ? chunk.rows.rowWeights(r) : NULL;    // NULL: no neighbors
+        engine.sign(chunk.rows.row(r), chunk.rows.rowEnd(r), weights, hashes.data());
+        chunk.insert(static_cast<int>(r), hashes.data());
+
+        first = eol + 1;
       }
-      std::cout << std::endl;
-    }*/
+    }
 
-    std::map<long long int, int>::iterator it = mp.begin();
+  }
+
+  /*
+   * What min() gives back: the adjacency lists of all the rows of the input, in order, and the clusters of row
+   * indexes (0-based) found among them. Both are moved out of min(), never copied.
+   */
+  struct Result {
+    Adjacency graph;
     std::vector<std::vector<int>> clusters;
-    for (it; it != mp.end(); ++it) {
-      // std::cout<<it->first<<' '<<it->second<<'\n';
-      std::vector<int> aux;
-      long long int key = it->first;
-      int value = it->second;
-      if (value > 1 && key != INT_MAX) {
-        for (int i = 0; i < arr.size(); ++i) {
-          long long int h1 = arr[i][0], h2 = arr[i][1];
-          if (h1 == key || h2 == key) {
-            aux.push_back(i);
-          }
-        }
-        clusters.push_back(aux);
+  };
+
+  /*
+   * Cluster the rows of the input file by MinHash. There is no global state: several inputs can be processed, even
+   * concurrently, in the same process.
+   *
+   * Neighbor ids must be in 0..2^32-2: any other id throws std::invalid_argument, rather than colliding silently
+   * with another one.
+   */
+  Result min(std::string input, const Parameters& params = Parameters()) {
+    if (params.weighted && params.onePermutation)
+      throw std::invalid_argument("minhash::min(): weighted signatures can't be computed by one permutation hashing");
+    if (params.signatureBits != 8 && params.signatureBits != 16 && params.signatureBits != 32)
+      throw std::invalid_argument("minhash::min(): signatures must have 8, 16 or 32 bits");
+    if (params.signatureBits == 8 && params.rowsPerBand == 1)
+      throw std::invalid_argument("minhash::min(): bands of a single 8-bit signature give too big buckets");
+
+    const odsg::io::MappedFile file(input);
+
+    // Several chunks by thread, to balance the load between them
+    odsg::parallel::ThreadPool pool(params.threads);
+    std::size_t chunksCount = params.threads == 1 ? 1 : 8 * params.threads;
+    std::vector<std::size_t> bounds = odsg::io::line_aligned_bounds(file.data(), file.size(), chunksCount);
+
+    std::vector<detail::Chunk> chunks(chunksCount, detail::Chunk(params));
+    const unsigned int P = params.signaturesCount();
+    pool.run(chunksCount, [&](std::size_t i) {
+      const char* first = file.data() + bounds[i];
+      const char* last = file.data() + bounds[i + 1];
+      if (params.weighted)
+        detail::parseAndSignWeighted(first, last, WeightedSignatureEngine(P, params.seed), chunks[i]);
+      else if (params.onePermutation)
+        detail::parseAndSign(first, last, OnePermutationEngine(P, params.seed), chunks[i]);
+      else
+        detail::parseAndSign(first, last, SignatureEngine(P, params.seed), chunks[i]);
+    });
+
+    // Merging the chunks in order gives the same rows and buckets as a sequential pass
+    Result result;
+    BandTables tables(params.bands, params.rowsPerBand);
+    SignatureMatrix matrix(P, params.signatureBits);
+
+    std::size_t rowsTotal = 0, neighborsTotal = 0, signedTotal = 0;
+    for (std::size_t i = 0; i < chunksCount; ++i) {
+      rowsTotal += chunks[i].rows.rowsCount();
+      neighborsTotal += chunks[i].rows.neighborsCount();
+      signedTotal += chunks[i].matrix.rowsCount();
+    }
+    // The first chunk becomes the graph (and the signature matrix) of the result
+    chunks[0].rows.reserve(rowsTotal, neighborsTotal);
+    chunks[0].matrix.reserve(signedTotal);
+
+    for (std::size_t i = 0; i < chunksCount; ++i) {
+      detail::Chunk& chunk = chunks[i];
+
+      tables.merge(chunk.tables, static_cast<int>(result.graph.rowsCount()));
+      if (i == 0) {
+        result.graph = std::move(chunk.rows);   // With a single chunk, the graph is never copied
+        matrix = std::move(chunk.matrix);
+      } else {
+        matrix.merge(chunk.matrix, static_cast<int>(result.graph.rowsCount()));
+        result.graph.append(chunk.rows);
       }
+      chunks[i] = detail::Chunk(params);     // Release the memory of the chunk as soon as possible
     }
-    /*for (int i = 0; i < clusters.size(); ++i) {
+
+    if (params.bBit())
+      result.clusters = matrix.clusters(params.bands, params.rowsPerBand, params.minSimilarity);
+    else
+      result.clusters = tables.clusters();
+    /*for (int i = 0; i < result.clusters.size(); ++i) {
       std::cout<<"Cluster "<<i+1<<": ";
-      for (int j = 0; j < clusters[i].size(); ++j) {
-          std::cout<<clusters[i][j]<<" ";
+      for (int j = 0; j < result.clusters[i].size(); ++j) {
+          std::cout<<result.clusters[i][j]<<" ";
       }std::cout<<'\n';
     }*/
 
-    return clusters;
+    return result;
   }
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,82 @@
+#ifndef MINHASH_ADJACENCY_HPP_INCLUDED
+#define MINHASH_ADJACENCY_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <vector>
+
+#include "signatures.hpp"
+#include "weighted.hpp"
+
+namespace minhash {
+
+
+/*
+ * The adjacency lists of a whole dataset in Compressed Sparse Row layout: all the neighbor ids one after the other
+ * in a single array, and the offset where each row starts. The neighbors of row r are
+ *   [row(r), rowEnd(r)),   with degree(r) == rowEnd(r) - row(r)
+ *
+ * Two allocations in total, whatever the number of rows, and cheap to move. Weighted datasets keep the weight of
+ * each interaction too, in a third array parallel to the neighbors.
+ */
+class Adjacency {
+public:
+    Adjacency(): offsets(1, 0), neighbors() {}
+
+    std::size_t rowsCount() const { return offsets.size() - 1; }
+    std::size_t neighborsCount() const { return neighbors.size(); }
+    bool empty() const { return rowsCount() == 0; }
+
+    std::size_t degree(std::size_t r) const { return offsets[r + 1] - offsets[r]; }
+    const Id* row(std::size_t r) const { return neighbors.data() + offsets[r]; }
+    const Id* rowEnd(std::size_t r) const { return neighbors.data() + offsets[r + 1]; }
+
+    bool isWeighted() const { return !weights.empty(); }
+    const Weight* rowWeights(std::size_t r) const { assert(isWeighted()); return weights.data() + offsets[r]; }
+
+    /*
+     * Rows are built by adding the neighbors of the last row one by one, and then closing it. All the neighbors
+     * must be given with their weight, or none of them.
+     */
+    void addNeighbor(Id id) { assert(!isWeighted()); neighbors.push_back(id); }
+    void addNeighbor(Id id, Weight weight) {
+        assert(weights.size() == neighbors.size());
+        neighbors.push_back(id);
+        weights.push_back(weight);
+    }
+    void closeRow() { offsets.push_back(neighbors.size()); }
+
+    /*
+     * Append all the rows of other after the rows of this object.
+     */
+    void append(const Adjacency& other);
+
+    void reserve(std::size_t rows, std::size_t neighborsTotal) {
+        offsets.reserve(rows + 1);
+        neighbors.reserve(neighborsTotal);
+    }
+
+private:
+    std::vector<std::size_t> offsets;
+    std::vector<Id> neighbors;
+    std::vector<Weight> weights;        // Empty if not weighted
+};
+
+
+inline void
+Adjacency::append(const Adjacency& other) {
+    std::size_t shift = neighbors.size();
+
+    assert(isWeighted() == other.isWeighted() || neighbors.empty() || other.neighbors.empty());
+
+    neighbors.insert(neighbors.end(), other.neighbors.begin(), other.neighbors.end());
+    weights.insert(weights.end(), other.weights.begin(), other.weights.end());
+    for (std::size_t r = 1; r < other.offsets.size(); ++r) {
+        offsets.push_back(other.offsets[r] + shift);
+    }
+    assert(offsets.back() == neighbors.size());
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_ADJACENCY_HPP_INCLUDED
@@ -0,0 +1,196 @@
+#ifndef MINHASH_BANDING_HPP_INCLUDED
+#define MINHASH_BANDING_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <stdint.h>     // uint64_t
+#include <vector>
+
+#include "bucketIndex.hpp"
+#include "signatures.hpp"
+
+namespace minhash {
+
+
+typedef uint64_t BandKey;
+
+
+/*
+ * Key of a band of r consecutive signatures. For r = 1 it's the signature itself; otherwise the signatures are
+ * folded with a 64-bit polynomial hash, so two rows share a bucket only if (with high probability) all the r
+ * signatures of the band are the same.
+ */
+inline BandKey
+bandKey(const Signature* signatures, unsigned int rowsPerBand) {
+    if (rowsPerBand == 1)
+        return signatures[0];
+
+    BandKey key = 0xCBF29CE484222325ULL;
+    for (unsigned int i = 0; i < rowsPerBand; ++i) {
+        key = (key ^ signatures[i]) * 0x100000001B3ULL;
+        key ^= key >> 29;
+    }
+    return key;
+}
+
+
+/*
+ * BandTables objects implement the banding technique of Locality-Sensitive Hashing over MinHash signatures: the
+ * b * r signatures of each row are split in b bands of r signatures, and each band is hashed in its own table of
+ * buckets. Two rows are candidates to be in the same cluster when they agree in all the signatures of at least one
+ * band, so raising r makes clusters tighter and raising b recovers recall.
+ *
+ * Each bucket with more than one row is a cluster. Clusters are listed band after band and, inside a band, in
+ * order of first apparition of their buckets; the rows of each cluster are listed in increasing order.
+ *
+ * Inserting a row only records, for each band, the id of its bucket in a flat BucketIndex. The clusters are then
+ * materialized in a single counting-sort pass over those ids, so both time and memory are linear in the number of
+ * rows, whatever the number of buckets.
+ *
+ * Tables can be filled in parallel, by consecutive ranges of rows, and then merged: merging the tables of the
+ * ranges in order gives exactly the same clusters as inserting all the rows in a single table.
+ *
+ * With 1 signature by band, this is not the same as the single map of signatures that min() used before, even for
+ * the default 2 bands:
+ *   - Each band has its own table, so a row whose first signature equals the second signature of another row no
+ *     longer shares a cluster with it.
+ *   - A row whose two signatures are equal counts once in its buckets, so it no longer forms a cluster alone.
+ *   - Clusters come band after band, in order of first apparition, instead of by increasing signature.
+ */
+class BandTables {
+public:
+    BandTables(unsigned int bands, unsigned int rowsPerBand);
+
+    unsigned int bandsCount() const { return static_cast<unsigned int>(tables.size()); }
+    unsigned int rowsPerBand() const { return rows; }
+
+    /*
+     * Add a row, given by its bandsCount() * rowsPerBand() signatures. Rows must be inserted by increasing index.
+     * Rows without shingles (EMPTY_SIGNATURE) are ignored.
+     */
+    void insert(int row, const Signature* signatures);
+
+    /*
+     * Append all the rows of other, shifting their indexes by rowOffset. All of them must come after the rows
+     * already inserted here. Both tables must have the same shape.
+     */
+    void merge(const BandTables& other, int rowOffset);
+
+    std::vector<std::vector<int> > clusters() const;
+
+private:
+    unsigned int rows;
+
+    std::vector<int> insertedRows;      // Rows with shingles, in increasing order
+
+    struct Table {
+        BucketIndex index;
+        std::vector<BucketIndex::BucketId> bucketOf;    // Bucket of each row in insertedRows
+        std::vector<uint32_t> bucketSizes;
+        std::vector<BandKey> bucketKeys;
+    };
+    std::vector<Table> tables;
+};
+
+
+inline
+BandTables::BandTables(unsigned int bands, unsigned int rowsPerBand): rows(rowsPerBand), tables(bands) {
+    assert(bands >= 1);
+    assert(rowsPerBand >= 1);
+}
+
+
+inline void
+BandTables::insert(int row, const Signature* signatures) {
+    if (signatures[0] == EMPTY_SIGNATURE)
+        return;     // No shingles at all: all the signatures are empty
+
+    assert(insertedRows.empty() || insertedRows.back() < row);
+    insertedRows.push_back(row);
+
+    for (std::size_t band = 0; band < tables.size(); ++band) {
+        Table& table = tables[band];
+
+        BandKey key = bandKey(signatures + band * rows, rows);
+        BucketIndex::BucketId bucket = table.index.findOrInsert(key);
+        if (bucket == table.bucketSizes.size()) {
+            table.bucketSizes.push_back(0);
+            table.bucketKeys.push_back(key);
+        }
+        table.bucketSizes[bucket]++;
+        table.bucketOf.push_back(bucket);
+    }
+}
+
+
+inline void
+BandTables::merge(const BandTables& other, int rowOffset) {
+    assert(other.rows == rows);
+    assert(other.tables.size() == tables.size());
+    assert(insertedRows.empty() || other.insertedRows.empty()
+           || insertedRows.back() < other.insertedRows.front() + rowOffset);
+
+    for (std::vector<int>::const_iterator it = other.insertedRows.begin(); it != other.insertedRows.end(); ++it) {
+        insertedRows.push_back(*it + rowOffset);
+    }
+
+    std::vector<BucketIndex::BucketId> mergedIdOf;
+    for (std::size_t band = 0; band < tables.size(); ++band) {
+        Table& table = tables[band];
+        const Table& otherTable = other.tables[band];
+
+        // The buckets of other are visited in their order of first apparition, so the new ones get here the same
+        // ids that they would have got by inserting the rows one by one
+        mergedIdOf.resize(otherTable.bucketKeys.size());
+        for (std::size_t bucket = 0; bucket < otherTable.bucketKeys.size(); ++bucket) {
+            BandKey key = otherTable.bucketKeys[bucket];
+            BucketIndex::BucketId merged = table.index.findOrInsert(key);
+            if (merged == table.bucketSizes.size()) {
+                table.bucketSizes.push_back(0);
+                table.bucketKeys.push_back(key);
+            }
+            table.bucketSizes[merged] += otherTable.bucketSizes[bucket];
+            mergedIdOf[bucket] = merged;
+        }
+
+        table.bucketOf.reserve(table.bucketOf.size() + otherTable.bucketOf.size());
+        for (std::size_t i = 0; i < otherTable.bucketOf.size(); ++i) {
+            table.bucketOf.push_back(mergedIdOf[otherTable.bucketOf[i]]);
+        }
+    }
+}
+
+
+inline std::vector<std::vector<int> >
+BandTables::clusters() const {
+    std::vector<std::vector<int> > clusters;
+
+    std::vector<std::size_t> offsets;
+    std::vector<int> members(insertedRows.size());
+
+    for (std::vector<Table>::const_iterator tit = tables.begin(); tit != tables.end(); ++tit) {
+        const Table& table = *tit;
+
+        // Counting sort of the rows by bucket; being a stable sort, the rows keep their increasing order
+        offsets.assign(table.bucketSizes.size() + 1, 0);
+        for (std::size_t bucket = 0; bucket < table.bucketSizes.size(); ++bucket)
+            offsets[bucket + 1] = offsets[bucket] + table.bucketSizes[bucket];
+
+        for (std::size_t i = 0; i < insertedRows.size(); ++i)
+            members[offsets[table.bucketOf[i]]++] = insertedRows[i];
+
+        // After the scattering, offsets[bucket] points to the end of the bucket, i.e. the start of the next one
+        std::size_t begin = 0;
+        for (std::size_t bucket = 0; bucket < table.bucketSizes.size(); ++bucket) {
+            std::size_t end = offsets[bucket];
+            if (end - begin > 1)
+                clusters.push_back(std::vector<int>(members.begin() + begin, members.begin() + end));
+            begin = end;
+        }
+    }
+    return clusters;
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_BANDING_HPP_INCLUDED
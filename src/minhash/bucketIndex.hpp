@@ -0,0 +1,114 @@
+#ifndef MINHASH_BUCKET_INDEX_HPP_INCLUDED
+#define MINHASH_BUCKET_INDEX_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <stdint.h>     // uint32_t, uint64_t
+#include <vector>
+
+namespace minhash {
+
+
+/*
+ * A flat hash index from 64-bit bucket keys to dense bucket ids (0, 1, 2... in order of first apparition of each
+ * key). It's an open addressing table with linear probing over two plain arrays, so looking up a key costs O(1)
+ * expected time and no allocation per key; it grows by doubling, keeping the load factor under 1/2.
+ */
+class BucketIndex {
+public:
+    typedef uint64_t Key;
+    typedef uint32_t BucketId;
+
+    explicit BucketIndex(std::size_t expectedKeys=0);
+
+    /*
+     * Id of the bucket of the given key; an unknown key gets the next unused id.
+     */
+    BucketId findOrInsert(Key);
+
+    /*
+     * Id of the bucket of the given key, or NO_BUCKET if the key is unknown.
+     */
+    BucketId find(Key) const;
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    static const BucketId NO_BUCKET = 0xFFFFFFFF;
+
+private:
+    std::vector<Key> keys;
+    std::vector<BucketId> ids;      // NO_BUCKET for free slots
+    std::size_t count;
+    unsigned int shift;             // 64 - log2(slots)
+
+    std::size_t slotOf(Key key) const { return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift); }
+
+    void rehash(unsigned int log2Slots);
+};
+
+
+inline
+BucketIndex::BucketIndex(std::size_t expectedKeys): keys(), ids(), count(0), shift(64) {
+    unsigned int log2Slots = 4;
+    while ((std::size_t(1) << log2Slots) < 2 * expectedKeys)
+        ++log2Slots;
+    rehash(log2Slots);
+}
+
+
+inline BucketIndex::BucketId
+BucketIndex::findOrInsert(Key key) {
+    std::size_t mask = ids.size() - 1;
+    for (std::size_t slot = slotOf(key); ; slot = (slot + 1) & mask) {
+        if (ids[slot] == NO_BUCKET) {
+            if (2 * (count + 1) > ids.size()) {
+                rehash(64 - shift + 1);
+                return findOrInsert(key);
+            }
+            keys[slot] = key;
+            ids[slot] = static_cast<BucketId>(count++);
+            return ids[slot];
+        }
+        if (keys[slot] == key)
+            return ids[slot];
+    }
+}
+
+
+inline BucketIndex::BucketId
+BucketIndex::find(Key key) const {
+    std::size_t mask = ids.size() - 1;
+    for (std::size_t slot = slotOf(key); ; slot = (slot + 1) & mask) {
+        if (ids[slot] == NO_BUCKET || keys[slot] == key)
+            return ids[slot];
+    }
+}
+
+
+inline void
+BucketIndex::rehash(unsigned int log2Slots) {
+    assert(log2Slots < 64);
+
+    std::vector<Key> oldKeys(std::size_t(1) << log2Slots);
+    std::vector<BucketId> oldIds(std::size_t(1) << log2Slots, BucketId(NO_BUCKET));
+    oldKeys.swap(keys);
+    oldIds.swap(ids);
+    shift = 64 - log2Slots;
+
+    std::size_t mask = ids.size() - 1;
+    for (std::size_t i = 0; i < oldIds.size(); ++i) {
+        if (oldIds[i] == NO_BUCKET)
+            continue;
+
+        std::size_t slot = slotOf(oldKeys[i]);
+        while (ids[slot] != NO_BUCKET)
+            slot = (slot + 1) & mask;
+        keys[slot] = oldKeys[i];
+        ids[slot] = oldIds[i];
+    }
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_BUCKET_INDEX_HPP_INCLUDED
@@ -0,0 +1,119 @@
+#ifndef MINHASH_ONE_PERMUTATION_HPP_INCLUDED
+#define MINHASH_ONE_PERMUTATION_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <stdint.h>     // uint32_t, uint64_t
+
+#include "signatures.hpp"
+
+namespace minhash {
+
+
+/*
+ * OnePermutationEngine objects compute K MinHash signatures of an adjacency list with a single hash by 2-shingle,
+ * instead of one hash by shingle and signature as SignatureEngine does: it's the 'one permutation hashing' (OPH)
+ * of Li, Owen & Zhang (2012). The 64-bit hash of each shingle is split in two halves: the high one selects one of
+ * the K bins, and the low one is the value kept if it's the minimum of its bin. So the cost of signing a list
+ * doesn't depend on K, and K can be raised to 64-128 signatures cheaply.
+ *
+ * Bins that got no shingle are filled by the 'rotation densification' of Shrivastava & Li (2014): an empty bin
+ * borrows the value of the nearest non-empty bin to its right (circularly), plus an offset proportional to the
+ * distance between both, so two lists agree in a densified bin only if they agree in the borrowed one at the same
+ * distance. It's a single O(K) pass, even for lists with far fewer shingles than bins, which are the common case
+ * in PPI networks.
+ *
+ * Like SignatureEngine, the signatures depend only on the seed and K, and it's interchangeable with it.
+ */
+class OnePermutationEngine {
+public:
+    explicit OnePermutationEngine(unsigned int signaturesCount=2, uint64_t seed=DEFAULT_SEED);
+
+    unsigned int size() const { return K; }
+
+    /*
+     * Write size() signatures for the adjacency list [first, last) in out. For lists without shingles all of them
+     * are EMPTY_SIGNATURE.
+     */
+    void sign(const Id* first, const Id* last, Signature* out) const;
+
+private:
+    unsigned int K;
+
+    uint64_t A;     // Coefficients of the hash of the shingles
+    uint64_t B;
+    uint64_t C;
+
+    static const Signature DENSIFICATION_OFFSET = 0x9E3779B9;
+
+    unsigned int binOf(uint64_t hash) const {
+        return static_cast<unsigned int>(((hash >> 32) * K) >> 32);
+    }
+};
+
+
+inline
+OnePermutationEngine::OnePermutationEngine(unsigned int signaturesCount, uint64_t seed): K(signaturesCount) {
+    assert(signaturesCount >= 1);
+
+    uint64_t state = seed;
+    A = detail::splitmix64(state) | 1;
+    B = detail::splitmix64(state) | 1;
+    C = detail::splitmix64(state);
+}
+
+
+inline void
+OnePermutationEngine::sign(const Id* first, const Id* last, Signature* out) const {
+    for (unsigned int k = 0; k < K; ++k)
+        out[k] = EMPTY_SIGNATURE;
+
+    if (last - first < 2)
+        return;
+
+    // A single pass over the shingles, each one hashed only once
+    unsigned int nonEmptyBins = 0;
+    for (const Id* it = first; it + 1 < last; ++it) {
+        uint64_t h = detail::fmix64(A * it[0] + B * it[1] + C);
+
+        Signature value = static_cast<Signature>(h);
+        if (value == EMPTY_SIGNATURE)
+            value--;
+
+        Signature& bin = out[binOf(h)];
+        if (bin == EMPTY_SIGNATURE)
+            nonEmptyBins++;
+        if (value < bin)
+            bin = value;
+    }
+
+    if (nonEmptyBins == K)
+        return;
+
+    // Rotation densification. The bins are visited right to left, starting from the last non-empty one, so each
+    // empty bin is visited after its donor and before any hashed bin on its left could be mistaken for one.
+    unsigned int lastHashed = K - 1;
+    while (out[lastHashed] == EMPTY_SIGNATURE)
+        --lastHashed;
+
+    Signature donor = out[lastHashed];
+    Signature distance = 0;
+    unsigned int k = lastHashed;
+    for (unsigned int step = 1; step < K; ++step) {
+        k = (k == 0) ? K - 1 : k - 1;
+
+        if (out[k] != EMPTY_SIGNATURE) {
+            donor = out[k];
+            distance = 0;
+        } else {
+            ++distance;
+            out[k] = donor + distance * DENSIFICATION_OFFSET;
+            if (out[k] == EMPTY_SIGNATURE)
+                out[k]--;
+        }
+    }
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_ONE_PERMUTATION_HPP_INCLUDED
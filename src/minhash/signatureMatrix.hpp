@@ -0,0 +1,260 @@
+#ifndef MINHASH_SIGNATURE_MATRIX_HPP_INCLUDED
+#define MINHASH_SIGNATURE_MATRIX_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <algorithm>    // std::max, std::min
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memcpy
+#include <stdint.h>     // uint8_t, uint16_t, uint32_t
+#include <vector>
+
+#include "banding.hpp"
+#include "bucketIndex.hpp"
+#include "signatures.hpp"
+
+namespace minhash {
+
+
+/*
+ * SignatureMatrix objects keep the signatures of all the rows in a single contiguous array, truncated to their b
+ * highest bits ('b-bit minwise hashing', Li & König 2010), with b = 8, 16 or 32. So 128 signatures of 8 bits take
+ * 128 bytes by row, without any allocation by row. Rows without shingles aren't stored, like in BandTables.
+ *
+ * The clusters are computed afterwards by LSH banding, band by band, so only the buckets of a single band are in
+ * memory at a time; their order is the same as in BandTables. Two unrelated rows agree in a b-bit signature with
+ * probability 2^-b, instead of ~0, so the estimate of the similarity from the fraction P of matching signatures is
+ * corrected as
+ *   J = (P - 2^-b) / (1 - 2^-b)
+ * and each bucket gives the connected components of its rows linked by a corrected similarity above minSimilarity,
+ * leaving out the rows without any such link; so the clusters don't depend on the order of the rows in the bucket.
+ * That's quadratic in the size of the buckets: with 8 bits, bands of a single signature are rejected, since each
+ * bucket would get about 1/256 of all the rows.
+ *
+ * Like BandTables, matrices can be filled in parallel by consecutive ranges of rows, and then merged in order.
+ */
+class SignatureMatrix {
+public:
+    SignatureMatrix(unsigned int signaturesCount, unsigned int bits);
+
+    unsigned int signaturesCount() const { return K; }
+    unsigned int bits() const { return b; }
+    std::size_t rowsCount() const { return insertedRows.size(); }
+
+    /*
+     * Add a row, given by its signaturesCount() signatures. Rows must be inserted by increasing index.
+     * Rows without shingles (EMPTY_SIGNATURE) are ignored.
+     */
+    void insert(int row, const Signature* signatures);
+
+    /*
+     * Append all the rows of other, shifting their indexes by rowOffset. All of them must come after the rows
+     * already inserted here. Both matrices must have the same shape.
+     */
+    void merge(const SignatureMatrix& other, int rowOffset);
+
+    /*
+     * The k-th (truncated) signature of the i-th stored row.
+     */
+    Signature at(std::size_t i, unsigned int k) const;
+
+    /*
+     * Corrected estimate of the Jaccard similarity between the i-th and j-th stored rows; it can be negative.
+     */
+    double similarity(std::size_t i, std::size_t j) const;
+
+    void reserve(std::size_t rows) {
+        insertedRows.reserve(rows);
+        cells.reserve(rows * K * (b / 8));
+    }
+
+    std::vector<std::vector<int> > clusters(unsigned int bands, unsigned int rowsPerBand,
+                                            double minSimilarity=0.0) const;
+
+private:
+    void appendComponents(const std::size_t* members, std::size_t count, double minSimilarity,
+                          std::vector<std::vector<int> >& clusters) const;
+
+    unsigned int K;
+    unsigned int b;
+
+    std::vector<int> insertedRows;      // Rows with shingles, in increasing order
+    std::vector<uint8_t> cells;         // K * b / 8 bytes by row
+};
+
+
+inline
+SignatureMatrix::SignatureMatrix(unsigned int signaturesCount, unsigned int bits)
+        : K(signaturesCount), b(bits), insertedRows(), cells() {
+    assert(signaturesCount >= 1);
+    assert(bits == 8 || bits == 16 || bits == 32);
+}
+
+
+inline void
+SignatureMatrix::insert(int row, const Signature* signatures) {
+    if (signatures[0] == EMPTY_SIGNATURE)
+        return;     // No shingles at all: all the signatures are empty
+
+    assert(insertedRows.empty() || insertedRows.back() < row);
+    insertedRows.push_back(row);
+
+    std::size_t offset = cells.size();
+    cells.resize(offset + K * (b / 8));
+    for (unsigned int k = 0; k < K; ++k) {
+        if (b == 8) {
+            cells[offset + k] = static_cast<uint8_t>(signatures[k] >> 24);
+        } else if (b == 16) {
+            uint16_t cell = static_cast<uint16_t>(signatures[k] >> 16);
+            std::memcpy(&cells[offset + 2 * k], &cell, sizeof(cell));
+        } else {
+            uint32_t cell = signatures[k];
+            std::memcpy(&cells[offset + 4 * k], &cell, sizeof(cell));
+        }
+    }
+}
+
+
+inline void
+SignatureMatrix::merge(const SignatureMatrix& other, int rowOffset) {
+    assert(other.K == K && other.b == b);
+    assert(insertedRows.empty() || other.insertedRows.empty()
+           || insertedRows.back() < other.insertedRows.front() + rowOffset);
+
+    for (std::vector<int>::const_iterator it = other.insertedRows.begin(); it != other.insertedRows.end(); ++it) {
+        insertedRows.push_back(*it + rowOffset);
+    }
+    cells.insert(cells.end(), other.cells.begin(), other.cells.end());
+}
+
+
+inline Signature
+SignatureMatrix::at(std::size_t i, unsigned int k) const {
+    const uint8_t* cell = &cells[(i * K + k) * (b / 8)];
+    if (b == 8)
+        return *cell;
+    if (b == 16) {
+        uint16_t value;
+        std::memcpy(&value, cell, sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    std::memcpy(&value, cell, sizeof(value));
+    return value;
+}
+
+
+inline double
+SignatureMatrix::similarity(std::size_t i, std::size_t j) const {
+    unsigned int matches = 0;
+    for (unsigned int k = 0; k < K; ++k) {
+        if (at(i, k) == at(j, k))
+            matches++;
+    }
+
+    double chance = 1.0 / static_cast<double>(uint64_t(1) << b);
+    return (static_cast<double>(matches) / K - chance) / (1.0 - chance);
+}
+
+
+inline std::vector<std::vector<int> >
+SignatureMatrix::clusters(unsigned int bands, unsigned int rowsPerBand, double minSimilarity) const {
+    assert(bands * rowsPerBand <= K);
+    assert(b > 8 || rowsPerBand > 1);
+
+    std::vector<std::vector<int> > clusters;
+
+    std::vector<Signature> band(rowsPerBand);
+    std::vector<BucketIndex::BucketId> bucketOf(rowsCount());
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> members(rowsCount());
+
+    for (unsigned int bnd = 0; bnd < bands; ++bnd) {
+        BucketIndex index;
+        std::vector<uint32_t> bucketSizes;
+
+        for (std::size_t i = 0; i < rowsCount(); ++i) {
+            for (unsigned int k = 0; k < rowsPerBand; ++k)
+                band[k] = at(i, bnd * rowsPerBand + k);
+
+            BucketIndex::BucketId bucket = index.findOrInsert(bandKey(band.data(), rowsPerBand));
+            if (bucket == bucketSizes.size())
+                bucketSizes.push_back(0);
+            bucketSizes[bucket]++;
+            bucketOf[i] = bucket;
+        }
+
+        // Counting sort of the rows by bucket, as in BandTables::clusters()
+        offsets.assign(bucketSizes.size() + 1, 0);
+        for (std::size_t bucket = 0; bucket < bucketSizes.size(); ++bucket)
+            offsets[bucket + 1] = offsets[bucket] + bucketSizes[bucket];
+
+        for (std::size_t i = 0; i < rowsCount(); ++i)
+            members[offsets[bucketOf[i]]++] = i;
+
+        std::size_t begin = 0;
+        for (std::size_t bucket = 0; bucket < bucketSizes.size(); ++bucket) {
+            std::size_t end = offsets[bucket];
+            if (end - begin > 1)
+                appendComponents(&members[begin], end - begin, minSimilarity, clusters);
+            begin = end;
+        }
+    }
+    return clusters;
+}
+
+
+/*
+ * Append the connected components of the given stored rows, linking the pairs with a similarity above
+ * minSimilarity, by union-find. Components are given by their first row, with their rows in the given order.
+ *
+ * The pairs are compared until a single component is left, so a bucket of near-duplicate rows takes about count
+ * similarities; a bucket of dissimilar rows still takes count * (count - 1) / 2 of them.
+ */
+inline void
+SignatureMatrix::appendComponents(const std::size_t* members, std::size_t count, double minSimilarity,
+                                  std::vector<std::vector<int> >& clusters) const {
+    std::vector<std::size_t> parent(count);
+    for (std::size_t m = 0; m < count; ++m)
+        parent[m] = m;
+
+    const auto root = [&parent](std::size_t m) {
+        while (parent[m] != m)
+            m = parent[m] = parent[parent[m]];
+        return m;
+    };
+
+    std::size_t components = count;
+    for (std::size_t m = 0; m < count && components > 1; ++m) {
+        for (std::size_t n = m + 1; n < count && components > 1; ++n) {
+            std::size_t rm = root(m), rn = root(n);
+            if (rm != rn && similarity(members[m], members[n]) > minSimilarity) {
+                parent[std::max(rm, rn)] = std::min(rm, rn);    // The root is always the first row of its component
+                --components;
+            }
+        }
+    }
+
+    // The roots come before their rows, so each component is opened by its first row
+    std::vector<std::size_t> componentOf(count);
+    std::size_t first = clusters.size();
+    for (std::size_t m = 0; m < count; ++m) {
+        std::size_t r = root(m);
+        if (r == m) {
+            componentOf[m] = clusters.size();
+            clusters.push_back(std::vector<int>());
+        }
+        clusters[componentOf[r]].push_back(insertedRows[members[m]]);
+    }
+
+    // Rows without links are left out
+    std::size_t kept = first;
+    for (std::size_t c = first; c < clusters.size(); ++c) {
+        if (clusters[c].size() > 1)
+            clusters[kept++].swap(clusters[c]);
+    }
+    clusters.resize(kept);
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_SIGNATURE_MATRIX_HPP_INCLUDED
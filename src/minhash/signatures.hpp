@@ -0,0 +1,174 @@
+#ifndef MINHASH_SIGNATURES_HPP_INCLUDED
+#define MINHASH_SIGNATURES_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <stdint.h>     // uint32_t, uint64_t
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace minhash {
+
+
+typedef uint32_t Id;            // Neighbor ids are hashed as 32-bit integers
+typedef uint32_t Signature;
+
+/*
+ * Signature of an adjacency list without 2-shingles (i.e. with less than two neighbors). It's never produced by
+ * hashing a real shingle, so it can be safely used as a marker.
+ */
+const Signature EMPTY_SIGNATURE = 0xFFFFFFFF;
+
+const uint64_t DEFAULT_SEED = 0x9E3779B97F4A7C15ULL;
+
+
+namespace detail {      // Internal stuff to this header file
+
+    /*
+     * SplitMix64 step, used only to expand a seed into the coefficients of the hash functions.
+     * See: http://xoshiro.di.unimi.it/splitmix64.c
+     */
+    inline uint64_t
+    splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+     * Finalizer of MurmurHash3: spreads all the bits of the input over all the bits of the output.
+     */
+    inline uint64_t
+    fmix64(uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xFF51AFD7ED558CCDULL;
+        k ^= k >> 33;
+        k *= 0xC4CEB9FE1A85EC53ULL;
+        return k ^ (k >> 33);
+    }
+
+}   // namespace detail
+
+
+/*
+ * Minimum of a range of signatures; EMPTY_SIGNATURE for an empty range.
+ *
+ * The vectorized kernels are chosen at compile time (-mavx2 or -msse4.1); all of them give the same result as the
+ * scalar fallback, so the signatures don't depend on the machine where they were computed.
+ */
+inline Signature
+minReduce(const Signature* values, std::size_t n) {
+    Signature minimum = EMPTY_SIGNATURE;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256i acc = _mm256_set1_epi32(-1);
+        for ( ; i + 8 <= n; i += 8) {
+            acc = _mm256_min_epu32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        }
+        __m128i half = _mm_min_epu32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        minimum = static_cast<Signature>(_mm_cvtsi128_si32(half));
+    }
+#elif defined(__SSE4_1__)
+    if (n >= 4) {
+        __m128i acc = _mm_set1_epi32(-1);
+        for ( ; i + 4 <= n; i += 4) {
+            acc = _mm_min_epu32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+        }
+        acc = _mm_min_epu32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_min_epu32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        minimum = static_cast<Signature>(_mm_cvtsi128_si32(acc));
+    }
+#endif
+
+    for ( ; i < n; ++i) {       // Scalar fallback, and the tail of the vectorized kernels
+        if (values[i] < minimum)
+            minimum = values[i];
+    }
+    return minimum;
+}
+
+
+/*
+ * SignatureEngine objects compute the MinHash signatures of adjacency lists, taking as shingles the pairs (u, v)
+ * of consecutive neighbor ids. Each pair is hashed directly as integers (no string is ever built) by a family of
+ * seeded universal hash functions, of the 'multiply-add-shift' type:
+ *   h_k(u, v) = (A_k u + B_k v + C_k) >> 32,   all in 64-bit arithmetic
+ *
+ * The coefficients are derived only from the seed, so the signatures are bit-identical across runs and machines
+ * for the same seed and number of signatures.
+ *
+ * A scratch buffer is kept in the object to avoid allocations per list: use one engine by thread.
+ */
+class SignatureEngine {
+public:
+    explicit SignatureEngine(unsigned int signaturesCount=2, uint64_t seed=DEFAULT_SEED);
+
+    unsigned int size() const { return static_cast<unsigned int>(A.size()); }
+
+    /*
+     * Hash of the shingle (u, v) by the k-th function of the family.
+     */
+    Signature hash(unsigned int k, Id u, Id v) const {
+        Signature h = static_cast<Signature>((A[k] * u + B[k] * v + C[k]) >> 32);
+        return h == EMPTY_SIGNATURE ? h - 1 : h;
+    }
+
+    /*
+     * Write size() signatures for the adjacency list [first, last) in out. For lists without shingles all of them
+     * are EMPTY_SIGNATURE.
+     */
+    void sign(const Id* first, const Id* last, Signature* out) const;
+
+private:
+    std::vector<uint64_t> A;
+    std::vector<uint64_t> B;
+    std::vector<uint64_t> C;
+
+    mutable std::vector<Signature> hashes;      // Scratch: the hashes of all the shingles of a list
+};
+
+
+inline
+SignatureEngine::SignatureEngine(unsigned int signaturesCount, uint64_t seed): A(), B(), C(), hashes() {
+    assert(signaturesCount >= 1);
+
+    uint64_t state = seed;
+    for (unsigned int k = 0; k < signaturesCount; ++k) {
+        A.push_back(detail::splitmix64(state) | 1);     // Odd multipliers
+        B.push_back(detail::splitmix64(state) | 1);
+        C.push_back(detail::splitmix64(state));
+    }
+}
+
+
+inline void
+SignatureEngine::sign(const Id* first, const Id* last, Signature* out) const {
+    std::size_t shingles = (last - first >= 2) ? static_cast<std::size_t>(last - first - 1) : 0;
+
+    if (hashes.size() < shingles)
+        hashes.resize(shingles);
+
+    for (unsigned int k = 0; k < size(); ++k) {
+        const uint64_t a = A[k], b = B[k], c = C[k];
+
+        for (std::size_t j = 0; j < shingles; ++j) {
+            Signature h = static_cast<Signature>((a * first[j] + b * first[j + 1] + c) >> 32);
+            hashes[j] = (h == EMPTY_SIGNATURE) ? h - 1 : h;
+        }
+        out[k] = minReduce(shingles ? &hashes[0] : NULL, shingles);
+    }
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_SIGNATURES_HPP_INCLUDED
@@ -0,0 +1,120 @@
+#ifndef MINHASH_WEIGHTED_HPP_INCLUDED
+#define MINHASH_WEIGHTED_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cmath>        // std::log, std::floor
+#include <cstddef>      // std::size_t
+#include <limits>
+#include <stdint.h>     // uint32_t, uint64_t
+#include <vector>
+
+#include "signatures.hpp"
+
+namespace minhash {
+
+
+typedef float Weight;
+
+
+/*
+ * WeightedSignatureEngine objects compute weighted MinHash signatures of adjacency lists whose interactions have
+ * a weight, by the 'improved consistent weighted sampling' (ICWS) of Ioffe (2010): the probability that two lists
+ * share a signature is their weighted Jaccard similarity, sum(min(w, w')) / sum(max(w, w')), instead of the plain
+ * Jaccard similarity of SignatureEngine.
+ *
+ * The weighted elements are the 2-shingles (u, v) of the list, as in the other engines, and a shingle weighs as
+ * its weakest interaction, min(w_u, w_v): shingles through weak interactions hardly ever decide a signature.
+ * Shingles without a positive weight are ignored. With all the weights equal, the collision probability is the
+ * same of SignatureEngine.
+ *
+ * The random variables of ICWS (two Gamma(2, 1), one Uniform(0, 1) by shingle and signature) are derived by
+ * hashing the shingle with the seeded coefficients of each signature, so the signatures depend only on the seed,
+ * the number of signatures and the weights. Each signature is the 32-bit hash of the pair (shingle, t) sampled by
+ * ICWS.
+ */
+class WeightedSignatureEngine {
+public:
+    explicit WeightedSignatureEngine(unsigned int signaturesCount=2, uint64_t seed=DEFAULT_SEED);
+
+    unsigned int size() const { return static_cast<unsigned int>(A.size()); }
+
+    /*
+     * Write size() signatures for the adjacency list [first, last), with weights [weights, weights + (last - first))
+     * in out. For lists without weighted shingles all of them are EMPTY_SIGNATURE.
+     */
+    void sign(const Id* first, const Id* last, const Weight* weights, Signature* out) const;
+
+private:
+    std::vector<uint64_t> A;
+    std::vector<uint64_t> B;
+    std::vector<uint64_t> C;
+
+    mutable std::vector<double> logWeights;     // Scratch: the log of the weight of all the shingles of a list
+
+    /*
+     * A double in the open interval (0, 1), from the 53 upper bits of a 64-bit hash.
+     */
+    static double uniform(uint64_t bits) {
+        return (static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+};
+
+
+inline
+WeightedSignatureEngine::WeightedSignatureEngine(unsigned int signaturesCount, uint64_t seed)
+        : A(), B(), C(), logWeights() {
+    assert(signaturesCount >= 1);
+
+    uint64_t state = seed;
+    for (unsigned int k = 0; k < signaturesCount; ++k) {
+        A.push_back(detail::splitmix64(state) | 1);     // Odd multipliers
+        B.push_back(detail::splitmix64(state) | 1);
+        C.push_back(detail::splitmix64(state));
+    }
+}
+
+
+inline void
+WeightedSignatureEngine::sign(const Id* first, const Id* last, const Weight* weights, Signature* out) const {
+    std::size_t shingles = (last - first >= 2) ? static_cast<std::size_t>(last - first - 1) : 0;
+
+    // The logarithms of the weights are shared by all the signatures; NaN marks the shingles to be ignored
+    if (logWeights.size() < shingles)
+        logWeights.resize(shingles);
+    for (std::size_t j = 0; j < shingles; ++j) {
+        Weight w = weights[j] < weights[j + 1] ? weights[j] : weights[j + 1];
+        logWeights[j] = (w > 0) ? std::log(static_cast<double>(w)) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    for (unsigned int k = 0; k < size(); ++k) {
+        const uint64_t a = A[k], b = B[k], c = C[k];
+
+        Signature best = EMPTY_SIGNATURE;
+        double bestLogA = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < shingles; ++j) {
+            if (logWeights[j] != logWeights[j])
+                continue;
+
+            uint64_t state = detail::fmix64(a * first[j] + b * first[j + 1] + c);
+            double r = -std::log(uniform(detail::splitmix64(state)) * uniform(detail::splitmix64(state)));
+            double logC = std::log(-std::log(uniform(detail::splitmix64(state))
+                                             * uniform(detail::splitmix64(state))));
+            double beta = uniform(detail::splitmix64(state));
+
+            // ICWS: t = floor(ln(w) / r + beta), and the shingle minimizing ln(a) = ln(c) - r (t - beta + 1) wins
+            double t = std::floor(logWeights[j] / r + beta);
+            double logA = logC - r * (t - beta + 1.0);
+            if (logA < bestLogA) {
+                bestLogA = logA;
+                uint64_t sample = state ^ static_cast<uint64_t>(static_cast<int64_t>(t));
+                Signature h = static_cast<Signature>(detail::fmix64(sample) >> 32);
+                best = (h == EMPTY_SIGNATURE) ? h - 1 : h;
+            }
+        }
+        out[k] = best;
+    }
+}
+
+
+}       // namespace minhash
+#endif  // MINHASH_WEIGHTED_HPP_INCLUDED
@@ -0,0 +1,80 @@
+#include "ClusteredGraph.hpp"
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <set>
+
+#include "Graph.hpp"
+#include "GraphCluster.hpp"
+
+namespace odsg {
+
+
+//// ClusteredGraph ///////////////////////////////////////////////////////////////////////////////////////////////////
+
+ClusteredGraph::ClusteredGraph(const std::vector<GraphCluster>& partition)
+: ClusteredGraph(partition.data(), partition.data() + partition.size()) {
+}
+
+
+ClusteredGraph::ClusteredGraph(const GraphCluster* first, const GraphCluster* last)
+: graph(first == last ? NULL : first->get_ptrGraph()), outlinks(), lists(), bounds(1, 0) {
+
+    std::size_t listsTotal = 0;
+    unsigned long arcsTotal = 0;
+    for (const GraphCluster* it = first; it != last; ++it) {
+        assert(it->get_ptrGraph() == graph);
+        listsTotal += it->listsCount();
+        arcsTotal += it->arcsCount();
+    }
+
+    // Reserved once and for all, as the lists point into outlinks
+    outlinks.reserve(arcsTotal);
+    lists.reserve(listsTotal);
+    bounds.reserve(static_cast<std::size_t>(last - first) + 1);
+
+    for (const GraphCluster* it = first; it != last; ++it) {
+        for (GraphCluster::const_iterator lit = it->begin(); lit != it->end(); ++lit) {
+            const Outlinks& adjacency = lit->second;
+
+            List list;
+            list.first = lit->first;
+            list.second.first = outlinks.data() + outlinks.size();
+            outlinks.insert(outlinks.end(), adjacency.begin(), adjacency.end());
+            list.second.last = outlinks.data() + outlinks.size();
+            lists.push_back(list);
+        }
+        bounds.push_back(lists.size());
+    }
+    assert(outlinks.size() == arcsTotal);
+}
+
+
+//// ClusterView //////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned long
+ClusterView::arcsCount() const {        // Implementation from GraphCluster::arcsCount()
+    unsigned long arcs = 0;
+
+    for (const_iterator it = begin(); it != end(); ++it) {
+        arcs += it->second.size();
+    }
+
+    return arcs;
+}
+
+
+std::size_t
+ClusterView::nodesCount() const {       // Implementation from GraphCluster::nodesCount()
+    std::set<Vertex> nodes;
+
+    for (const_iterator it = begin(); it != end(); ++it) {
+        nodes.insert(it->first);
+        nodes.insert(it->second.begin(), it->second.end());
+    }
+
+    assert(nodes.size() >= listsCount());
+    return nodes.size();
+}
+
+
+}   // namespace odsg
@@ -0,0 +1,102 @@
+#ifndef SRC_CLUSTERED_GRAPH_HPP_INCLUDED
+#define SRC_CLUSTERED_GRAPH_HPP_INCLUDED
+
+#include <cstddef>      // std::size_t
+#include <vector>
+
+#include "Graph.hpp"
+#include "Vertex.hpp"
+
+namespace odsg {
+
+
+class GraphCluster;
+class ClusterView;
+
+/*
+ * A ClusteredGraph object is a copy of the adjacency lists of a partition of a graph, laid out cluster after
+ * cluster: all the outlinks in a single contiguous array, and the lists (their vertex and the range of their
+ * outlinks) in another one, so each cluster is a [begin, end) slice of both.
+ *
+ * A Graph is already laid out that way as a whole (see Graph::lists), and a GraphCluster is a vector of pointers
+ * into its lists array: iterating a GraphCluster is an indirection by list, to lists and outlinks at the scattered
+ * offsets picked by the partitioner, while iterating a ClusterView is a linear scan. As the outlinks of each list
+ * are contiguous anyway, the gain is small, and the copy costs as much as building the dags; so it's an option (see
+ * DagForest), off by default, for partitions whose lists are spread over a graph much bigger than the caches.
+ *
+ * The lists keep their order inside each cluster, and the views keep a pointer to the original graph, so a dag
+ * built from a view is the same built from the respective cluster. The lifetime of the ClusteredGraph object must
+ * extend past any use of its views, but not past the dags built from them.
+ */
+class ClusteredGraph {
+public:
+    /*
+     * The adjacency lists are laid out as in Graph.
+     */
+    typedef Graph::Outlinks Outlinks;
+    typedef Graph::List List;
+
+    /*
+     * All the clusters must be from the same graph, with no list in common. Just a range of the clusters of a
+     * partition can be laid out, to bound the memory taken by the copy.
+     */
+    explicit ClusteredGraph(const std::vector<GraphCluster>& partition);
+    ClusteredGraph(const GraphCluster* first, const GraphCluster* last);
+
+    std::size_t clustersCount() const { return bounds.size() - 1; }
+    std::size_t listsCount() const { return lists.size(); }
+    unsigned long arcsCount() const { return static_cast<unsigned long>(outlinks.size()); }
+
+    ClusterView cluster(std::size_t) const;
+
+private:
+    const Graph* graph;
+
+    std::vector<Vertex> outlinks;
+    std::vector<List> lists;
+    std::vector<std::size_t> bounds;        // The i-th cluster is [bounds[i], bounds[i + 1]) of lists
+
+    // The next two are declared and deliberately NOT implemented, to prevent copying objects of this class: the
+    // lists point into outlinks
+    ClusteredGraph(const ClusteredGraph&);
+    ClusteredGraph& operator=(const ClusteredGraph&);
+};
+
+
+/*
+ * A cluster of a ClusteredGraph, with the same read-only interface of GraphCluster.
+ */
+class ClusterView {
+public:
+    typedef ClusteredGraph::List value_type;
+    typedef const ClusteredGraph::List* const_iterator;
+
+    ClusterView(const Graph* graph, const_iterator first, const_iterator last)
+    : ptr_graph(graph), first(first), last(last) {}
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return last; }
+
+    bool empty() const { return first == last; }
+
+    std::size_t listsCount() const { return static_cast<std::size_t>(last - first); }
+    std::size_t nodesCount() const;
+    unsigned long arcsCount() const;
+
+    const Graph* get_ptrGraph() const { return ptr_graph; }
+
+private:
+    const Graph* ptr_graph;
+    const_iterator first;
+    const_iterator last;
+};
+
+
+inline ClusterView
+ClusteredGraph::cluster(std::size_t i) const {
+    return ClusterView(graph, lists.data() + bounds[i], lists.data() + bounds[i + 1]);
+}
+
+
+}       // namespace odsg
+#endif  // SRC_CLUSTERED_GRAPH_HPP_INCLUDED
@@ -14,6 +14,7 @@
 #include <iostream>
 //==============================================================================
 #include "GraphCluster.hpp"
+#include "ClusteredGraph.hpp"
 #include "MinerDagTraveler.hpp"
 #include "MinerObjective.hpp"
 
@@ -56,6 +57,14 @@ Dag::Dag(const GraphCluster& cluster, bool comeSortedByVertex)
 
 }
 
+Dag::Dag(const ClusterView& cluster, bool comeSortedByVertex)
+: nodeCache(), roots(), maxNodeMaxDepth(0), fromGraphSortedByVertex(comeSortedByVertex),
+  ptr_graph(cluster.get_ptrGraph()) {
+
+    initialize(cluster);
+
+}
+
 
 template<typename GraphT>
 void
@@ -67,7 +76,7 @@ Dag::initialize(const GraphT& graph) {
         std::map<Vertex, DagNode*> tmpNodeMapCache;
 
         for (typename GraphT::const_iterator it = graph.begin(); it != graph.end(); ++it) {
-            insert(it->first, it->second, tmpNodeMapCache);
+            insert(it->first, it->second.data(), it->second.data() + it->second.size(), tmpNodeMapCache);
         }
         assert(tmpNodeMapCache.size() == graph.nodesCount());
 
@@ -89,12 +98,13 @@ Dag::initialize(const GraphT& graph) {
 
 
 void
-Dag::insert(Vertex vertex, const std::vector<Vertex>& outlinks, std::map<Vertex, DagNode*>& nodeMapCache) {
-    assert(algorithms::is_found(outlinks, vertex));     // Self-loops are present
-    assert(outlinks.size() > 1);                        // No trivial outlinks
+Dag::insert(Vertex vertex, const Vertex* firstOutlink, const Vertex* lastOutlink,
+            std::map<Vertex, DagNode*>& nodeMapCache) {
+    assert(std::find(firstOutlink, lastOutlink, vertex) != lastOutlink);    // Self-loops are present
+    assert(lastOutlink - firstOutlink > 1);                                 // No trivial outlinks
 
     DagNode* prevNode = NULL;
-    for (std::vector<Vertex>::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
+    for (const Vertex* vxit = firstOutlink; vxit != lastOutlink; ++vxit) {
         Vertex outlink = *vxit;
 
         DagNode* node = nodeMapCache[outlink];      // There will not be two nodes with the same label in the dag
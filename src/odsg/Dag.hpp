@@ -15,6 +15,7 @@ namespace odsg {
 class DenseSubGraphsMaximalSet;
 class Graph;
 class GraphCluster;
+class ClusterView;
 
 /*
  * A Dag object is a collection of DagNode objects linked between them, from where dense subgraphs are mined.
@@ -46,6 +47,7 @@ public:
      */
     explicit Dag(const Graph&);
     explicit Dag(const GraphCluster& cluster, bool comeSortedByVertex=false);
+    explicit Dag(const ClusterView& cluster, bool comeSortedByVertex=false);
 
     ~Dag();
 
@@ -66,6 +68,8 @@ public:
     std::size_t nodesCount() const { return nodeCache.size(); }
     unsigned long arcsCount() const;
 
+    unsigned int maxDepth() const { return maxNodeMaxDepth; }      // See maxNodeMaxDepth below
+
     /*
      * Mine a collection of maximal dense subgraphs from the dag.
      *
@@ -130,7 +134,7 @@ private:
     template<typename GraphT>
     void initialize(const GraphT&);
 
-    void insert(Vertex, const std::vector<Vertex>&, std::map<Vertex, DagNode*>&);
+    void insert(Vertex, const Vertex* firstOutlink, const Vertex* lastOutlink, std::map<Vertex, DagNode*>&);
     void setTopologicalCacheSorting(const std::map<Vertex, DagNode*>&);
     void updateNodeMaxDepths();
 
@@ -1,10 +1,12 @@
 #include "DagForest.hpp"
 
 #include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <algorithm>    // std::max
 #include <stdexcept>
 #include <fstream>
 #include <ostream>
 #include <memory>       // std::auto_ptr
+#include <functional>   // std::function
 //==============================================================================
 #include<iostream>
 //==============================================================================
@@ -13,76 +15,208 @@
 
 #include "Graph.hpp"
 #include "GraphCluster.hpp"
+#include "ClusteredGraph.hpp"
 #include "GraphPartitioner.hpp"
 
 namespace odsg {
 
 
-DagForest::DagForest(const          Graph& graph,
-                     int        clusteringScheme,
-                     unsigned int minClusterSize,
-                     bool sortClusterByFrequency)
-: forest() {
-
-    assert(clusteringScheme == 0 || clusteringScheme == 1 || clusteringScheme == 2);
+namespace {     // Put here general, global definitions limited to this file
 
-    if (graph.empty())
-        return;     // A empty graph will lead to a empty forest: hardly useful but allowed
+    Dag*
+    newDag(const Graph& graph, const GraphCluster& cluster, bool sortClusterByFrequency, unsigned int threadsCount) {
+        if (sortClusterByFrequency) {
+            // Due to the current overall workflow to build dags from graphs (sorting followed by clustering),
+            // to support without much pain this added-in-final-stages sortClusterByFrequency option (that
+            // requires clustering followed by sorting) it's inevitable to duplicate some data, maybe doing it
+            // not very suitable for huge social-web graphs.
+            Graph clusterGraph(cluster);        // It create a copy of the data
+            clusterGraph.rebuildForMiningExceptSorting();   // Required by VertexFrequencyComparer
+            clusterGraph.rebuildForMining(Graph::VertexFrequencyComparer(clusterGraph, threadsCount), threadsCount);
 
-    if (!graph.isMineable()) {
-        throw std::logic_error("DagForest::DagForest(): graph must be mineable");
+            return new Dag(clusterGraph);
+        } else {
+            return new Dag(cluster, graph.isSortedByVertex());
+        }
     }
 
-    std::vector<GraphCluster> partition;
-
-    GraphPartitioner* partitionerPtr = NULL;
-    switch (clusteringScheme) {
-        case 0:     // No partitioning
-            break;
-        case 1:     // Partitioning by common initial outlink
-            partitionerPtr = new GraphPartitionerByInitialOutlink(&graph);
-            break;
-        case 2:     // Partitioning by common hashing signature
-            partitionerPtr = new GraphPartitionerBySignature(&graph);
-            break;
+    GraphPartitioner*
+    newPartitioner(const Graph& graph, int clusteringScheme) {
+        assert(clusteringScheme >= 0 && clusteringScheme <= 3);
+
+        switch (clusteringScheme) {
+            case 1:     // Partitioning by common initial outlink
+                return new GraphPartitionerByInitialOutlink(&graph);
+            case 2:     // Partitioning by common hashing signature
+                return new GraphPartitionerBySignature(&graph);
+            case 3:     // Partitioning by connected components of shared second-level shingles
+                return new GraphPartitionerByTwoLevelShingles(&graph);
+            default:    // No partitioning
+                return NULL;
+        }
     }
-    if (partitionerPtr) {
-        std::auto_ptr<GraphPartitioner> partitioner(partitionerPtr);    // It takes care of delete the object
 
-        GraphCluster cluster = partitioner->next(minClusterSize);
-        while (!cluster.empty()) {
-            partition.push_back(cluster);
-            cluster = partitioner->next(minClusterSize);
+    /*
+     * The common core of the DagForest constructor and DagForest::stream(): build the dags of graph one by one, as
+     * the partitioner (none when NULL) gives each cluster, handing them to take(), that becomes their owner.
+     */
+    std::size_t
+    buildDags(const Graph& graph,
+              GraphPartitioner* partitioner,
+              unsigned int minClusterSize,
+              bool sortClusterByFrequency,
+              unsigned int maxClusterSize,
+              bool contiguousClusters,
+              unsigned int threadsCount,
+              const std::function<void(Dag*)>& take) {
+
+        assert(maxClusterSize == 0 || maxClusterSize >= minClusterSize);
+
+        if (graph.empty())
+            return 0;   // A empty graph will lead to a empty forest: hardly useful but allowed
+
+        if (!graph.isMineable()) {
+            throw std::logic_error("DagForest::DagForest(): graph must be mineable");
         }
-    }
 
-    // The partition is empty when no partitioning was set
-    if (partition.empty()) {
-        forest.push_back(new Dag(graph));
-    } else {
-        for (std::vector<GraphCluster>::const_iterator it = partition.begin(); it != partition.end(); ++it) {
+        if (!partitioner) {
+            take(new Dag(graph));
+            return 1;
+        }
 
-            if (sortClusterByFrequency) {
-                const GraphCluster& cluster = *it;
+        // Clusters sorted by frequency are copied to their own graph anyway, so there is nothing to lay out for them
+        contiguousClusters = contiguousClusters && !sortClusterByFrequency;
 
-                // Due to the current overall workflow to build dags from graphs (sorting followed by clustering),
-                // to support without much pain this added-in-final-stages sortClusterByFrequency option (that
-                // requires clustering followed by sorting) it's inevitable to duplicate some data, maybe doing it
-                // not very suitable for huge social-web graphs.
-                Graph clusterGraph(cluster);        // It create a copy of the data
-                clusterGraph.rebuildForMiningExceptSorting();   // Required by VertexFrequencyComparer
-                clusterGraph.rebuildForMining(Graph::VertexFrequencyComparer(clusterGraph));
+        std::size_t dagsCount = 0;
+        if (maxClusterSize > 0 || contiguousClusters) {
+            // Packing needs all the clusters to balance them, and laying them out needs all of them too, but they
+            // are only lists of iterators: the dags are still built one at a time
+            std::vector<GraphCluster> partition;
+            if (maxClusterSize > 0) {
+                partition = partitioner->pack(minClusterSize, maxClusterSize);
+            } else {
+                for (GraphCluster cluster = partitioner->next(minClusterSize); !cluster.empty();
+                     cluster = partitioner->next(minClusterSize)) {
+                    partition.push_back(cluster);
+                }
+            }
 
-                forest.push_back(new Dag(clusterGraph));
+            if (contiguousClusters) {
+                // The clusters are laid out by batches of up to the arcs of the biggest one, each one freed before
+                // laying out the next, so the copy never takes more memory than the biggest cluster
+                unsigned long batchArcs = 0;
+                for (std::vector<GraphCluster>::const_iterator it = partition.begin(); it != partition.end(); ++it)
+                    batchArcs = std::max(batchArcs, it->arcsCount());
+
+                for (std::size_t first = 0, last = 0; first < partition.size(); first = last) {
+                    unsigned long arcs = partition[first].arcsCount();
+                    for (last = first + 1; last < partition.size(); ++last) {
+                        if (arcs + partition[last].arcsCount() > batchArcs)
+                            break;
+                        arcs += partition[last].arcsCount();
+                    }
+
+                    const ClusteredGraph clusteredGraph(partition.data() + first, partition.data() + last);
+                    for (std::size_t i = first; i < last; ++i)
+                        partition[i] = GraphCluster();      // Not needed anymore: free it before mining
+
+                    for (std::size_t i = 0; i < clusteredGraph.clustersCount(); ++i) {
+                        take(new Dag(clusteredGraph.cluster(i), graph.isSortedByVertex()));
+                        ++dagsCount;
+                    }
+                }
             } else {
-                forest.push_back(new Dag(*it, graph.isSortedByVertex()));
+                for (std::vector<GraphCluster>::const_iterator it = partition.begin(); it != partition.end(); ++it) {
+                    take(newDag(graph, *it, sortClusterByFrequency, threadsCount));
+                    ++dagsCount;
+                }
+            }
+        } else {
+            for (GraphCluster cluster = partitioner->next(minClusterSize); !cluster.empty();
+                 cluster = partitioner->next(minClusterSize)) {
+                take(newDag(graph, cluster, sortClusterByFrequency, threadsCount));
+                ++dagsCount;
             }
         }
+
+        // When the partitioner gives nothing at all, the whole graph is a single dag, as with no partitioning
+        if (dagsCount == 0) {
+            take(new Dag(graph));
+            dagsCount = 1;
+        }
+        return dagsCount;
     }
 
+    /*
+     * Take the dags as they come, visiting and freeing them one by one.
+     */
+    std::function<void(Dag*)>
+    visitAndFree(const DagForest::DagVisitor& visit) {
+        return [&visit](Dag* dag) {
+            std::auto_ptr<const Dag> owner(dag);   // Freed as soon as it's visited, even on exceptions
+            visit(*owner);
+        };
+    }
+}
+
+
+DagForest::DagForest(const          Graph& graph,
+                     int        clusteringScheme,
+                     unsigned int minClusterSize,
+                     bool sortClusterByFrequency,
+                     unsigned int maxClusterSize,
+                     bool contiguousClusters,
+                     unsigned int threadsCount)
+: forest() {
+
+    assert(clusteringScheme >= 0 && clusteringScheme <= 3);
+
+    // An empty or not mineable graph gets no partitioner: buildDags() deals with it before using one
+    std::auto_ptr<GraphPartitioner> partitioner(graph.empty() || !graph.isMineable()
+                                                ? NULL : newPartitioner(graph, clusteringScheme));
+
+    buildDags(graph, partitioner.get(), minClusterSize, sortClusterByFrequency, maxClusterSize, contiguousClusters,
+              threadsCount, [this](Dag* dag) { forest.push_back(dag); });
+
     assert(size() <= graph.listsCount());
 }
 
+
+std::size_t
+DagForest::stream(const Graph& graph,
+                  const DagVisitor& visit,
+                  int clusteringScheme,
+                  unsigned int minClusterSize,
+                  bool sortClusterByFrequency,
+                  unsigned int maxClusterSize,
+                  bool contiguousClusters,
+                  unsigned int threadsCount) {
+
+    assert(clusteringScheme >= 0 && clusteringScheme <= 3);
+
+    std::auto_ptr<GraphPartitioner> partitioner(graph.empty() || !graph.isMineable()
+                                                ? NULL : newPartitioner(graph, clusteringScheme));
+
+    return buildDags(graph, partitioner.get(), minClusterSize, sortClusterByFrequency, maxClusterSize,
+                     contiguousClusters, threadsCount, visitAndFree(visit));
+}
+
+
+std::size_t
+DagForest::stream(const Graph& graph,
+                  GraphPartitioner& partitioner,
+                  const DagVisitor& visit,
+                  unsigned int minClusterSize,
+                  bool sortClusterByFrequency,
+                  unsigned int maxClusterSize,
+                  bool contiguousClusters,
+                  unsigned int threadsCount) {
+
+    return buildDags(graph, &partitioner, minClusterSize, sortClusterByFrequency, maxClusterSize,
+                     contiguousClusters, threadsCount, visitAndFree(visit));
+}
+
+
 DagForest::~DagForest() {
     for (iterator tit = begin(); tit != end(); ++tit) {
         delete *tit;
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <iosfwd>
+#include <functional>   // std::function
 
 #include "Dag.hpp"              // All of our container-like classes include the definition of the contained element
 
@@ -12,6 +13,7 @@ namespace odsg {
 
 
 class Graph;
+class GraphPartitioner;
 /*
  * The main motivations to have a collection of dags as an class (versus passing std::vector<Dag>, by example, all
  * around the place) were:
@@ -29,14 +31,46 @@ class DagForest {
 public:
     // Types
     typedef std::vector<const Dag*>::const_iterator const_iterator;
+    typedef std::function<void(const Dag&)> DagVisitor;
 
     // Constructors
     explicit DagForest(const Graph&,
                        int clusteringScheme=0,
                        unsigned int minClusterSize=1,       // With 'size' we refers to the number of arcs
-                       bool sortClusterByFrequency=false);  // It can throw an exception
+                       bool sortClusterByFrequency=false,
+                       unsigned int maxClusterSize=0,       // 0: no limit; else see GraphPartitioner::pack()
+                       bool contiguousClusters=false,       // Build the dags from a ClusteredGraph
+                       unsigned int threadsCount=1);        // To rebuild the clusters sorted by frequency
+                                                            // It can throw an exception
     ~DagForest();
 
+    /*
+     * Streaming alternative to building a whole forest: the dags are built one at a time, as the partitioner gives
+     * each cluster, handed to visit() and freed just after it, so at most one dag is alive at any time. Dags are
+     * visited in the same order a DagForest with the same arguments would keep them. Returns the number of dags.
+     */
+    static std::size_t stream(const Graph&,
+                              const DagVisitor& visit,
+                              int clusteringScheme=0,
+                              unsigned int minClusterSize=1,
+                              bool sortClusterByFrequency=false,
+                              unsigned int maxClusterSize=0,
+                              bool contiguousClusters=false,
+                              unsigned int threadsCount=1);     // It can throw an exception
+
+    /*
+     * The same, with a partitioner built by the caller, e.g. to configure it or to inspect it afterwards. It must
+     * partition the same graph.
+     */
+    static std::size_t stream(const Graph&,
+                              GraphPartitioner&,
+                              const DagVisitor& visit,
+                              unsigned int minClusterSize=1,
+                              bool sortClusterByFrequency=false,
+                              unsigned int maxClusterSize=0,
+                              bool contiguousClusters=false,
+                              unsigned int threadsCount=1);     // It can throw an exception
+
     // No public mutators: a dag forest isn't altered outside of the constructor & destructor
 
     // Iterators
@@ -1,17 +1,21 @@
 #include "Graph.hpp"
 
 #include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
-#include <cstdlib>      // std::rand, std::srand
 #include <set>
 #include <stdexcept>
 #include <iostream>
 #include <fstream>
 #include <ostream>
-#include <sstream>
-#include <iterator>     // std::advance
+#include <utility>      // std::pair
+#include <functional>   // std::greater_equal
 #include <ctime>        // std::time
+#include <random>       // std::mt19937_64
+#include <limits>
+#include <stdint.h>     // uint64_t
 
 #include "utils/algorithms.hpp"
+#include "utils/io.hpp"
+#include "utils/parallel.hpp"
 #include "utils/strings.hpp"
 #include "GraphCluster.hpp"
 
@@ -21,8 +25,8 @@ namespace odsg {
 namespace {     // Put here general, global definitions limited to this file
 
     std::ostream&
-    operator<<(std::ostream& os, const Graph::AdjacencyList& outlinks) {
-        for (Graph::AdjacencyList::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
+    operator<<(std::ostream& os, const Graph::Outlinks& outlinks) {
+        for (Graph::Outlinks::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
             if (vxit != outlinks.begin())
                 os << ' ';
             os << *vxit;
@@ -43,74 +47,346 @@ namespace {     // Put here general, global definitions limited to this file
                   << std::endl;
     }
 
-}   // namespace
-
 
-//// Graph ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /*
+     * The adjacency lists read from a range of whole lines of an input graph file, as the arrays of Graph::assign(),
+     * in the order of the file; its offsets start at 0. The lines are numbered from 1 by chunk, and the warnings
+     * about malformed ones are kept with their number and given only once all the chunks are parsed, to get their
+     * place in the whole file.
+     */
+    struct GraphFileChunk {
+        typedef std::pair<unsigned int, const char*> Warning;       // (line, description)
+
+        std::vector<Vertex> vertexes;
+        std::vector<std::size_t> offsets;
+        std::vector<Vertex> outlinks;
+        unsigned int linesCount;
+        std::vector<Warning> warnings;
+
+        GraphFileChunk(): vertexes(), offsets(1, 0), outlinks(), linesCount(0), warnings() {}
+
+        void swap(GraphFileChunk& chunk) {
+            vertexes.swap(chunk.vertexes);
+            offsets.swap(chunk.offsets);
+            outlinks.swap(chunk.outlinks);
+            std::swap(linesCount, chunk.linesCount);
+            warnings.swap(chunk.warnings);
+        }
+    };
 
-Graph::Graph(): innerGraph(), sortedByVertex(true), mineability(2) {}
 
+    inline bool
+    isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
 
-Graph::Graph(const std::string& fileName, bool comeSortedByVertex)
-: innerGraph(), sortedByVertex(comeSortedByVertex), mineability(0) {
 
-    assert(!fileName.empty());
+    /*
+     * Parse the next vertex id of [first, last), advancing first past it; as io::parse_integer(), but the values
+     * out of the range of the vertexes aren't ids either. As with std::istream, a negative value is taken modulo
+     * the range, if its magnitude fits in it.
+     */
+    inline bool
+    parseVertex(const char*& first, const char* last, Vertex& vertex) {
+        const long long int MAX = std::numeric_limits<Vertex>::max();
 
-    std::ifstream infile(fileName.c_str());
-    if (!infile) {
-        throw std::runtime_error("Graph::Graph(): can not open input graph file");
+        const char* p = first;
+        long long int value;
+        if (!io::parse_integer(p, last, value) || value < -MAX || value > MAX) {
+            return false;
+        }
+        vertex = static_cast<Vertex>(value);
+        first = p;
+        return true;
     }
 
-    unsigned int lineCount = 0;
-    std::string line;
-    while (std::getline(infile, line)) {
-        lineCount++;
 
-        if (line.empty() || line.find_first_not_of(" \t\n\v\f\r") == std::string::npos)
-            continue;
-        if (line[0] == graphFileFormat::COMMENTS_TOKEN)  // TODO: trim start of the line before checking
-            continue;
+    /*
+     * Parse the whole lines of [first, last) as reading them one by one with std::istringstream would: blank
+     * lines and comments are skipped, lines without a vertex and its delimiter at the start are warned about and
+     * ignored, and an adjacency list ends at the first thing that isn't a vertex id.
+     */
+    void
+    parseGraphFileChunk(const char* first, const char* last, bool comeSortedByVertex, GraphFileChunk& chunk) {
+        // Same as reading with getline: a final line without '\n' counts too, but not an empty one after the last '\n'
+        for (const char* eol; first < last; first = eol + 1) {
+            eol = io::end_of_line(first, last);
+            chunk.linesCount++;
+
+            if (std::find_if(first, eol, [](char c) { return !isSpace(c); }) == eol)
+                continue;
+            if (*first == graphFileFormat::COMMENTS_TOKEN)  // TODO: trim start of the line before checking
+                continue;
+
+            Vertex vertex;
+            if (!parseVertex(first, eol, vertex)) {
+                chunk.warnings.push_back(GraphFileChunk::Warning(chunk.linesCount, "no a vertex at the line start"));
+                continue;
+            }
 
-        std::istringstream iss(line);
+            while (first < eol && isSpace(*first))
+                ++first;
+            if (first == eol || *first != graphFileFormat::ADJACENCY_LIST_DELIMITER) {
+                chunk.warnings.push_back(GraphFileChunk::Warning(chunk.linesCount, "missing or wrong delimiter"));
+                continue;
+            }
+            ++first;
 
-        Vertex vertex;
-        if (!(iss >> vertex)) {
-            warnAboutInputFile(lineCount, "no a vertex at the line start", "ignoring line");
-            continue;
+            for (Vertex vx; parseVertex(first, eol, vx); ) {
+                chunk.outlinks.push_back(vx);
+            }
+            assert(!comeSortedByVertex
+                   || algorithms::is_sorted(Graph::AdjacencyList(chunk.outlinks.begin() + chunk.offsets.back(),
+                                                                 chunk.outlinks.end())));
+            assert(algorithms::has_unique(Graph::AdjacencyList(chunk.outlinks.begin() + chunk.offsets.back(),
+                                                               chunk.outlinks.end())));
+
+            // The remainings in the line are simply ignored
+
+            chunk.vertexes.push_back(vertex);
+            chunk.offsets.push_back(chunk.outlinks.size());
         }
-        assert(innerGraph.find(vertex) == end());    // Not an already known vertex
+    }
 
-        char delimiter = '\0';
-        if (!(iss >> delimiter) || delimiter != graphFileFormat::ADJACENCY_LIST_DELIMITER) {
-            warnAboutInputFile(lineCount, "missing or wrong delimiter", "ignoring line");
-            continue;
+
+    /*
+     * Sort by vertex the adjacency lists given as the arrays of Graph::assign(), but in any order; of the lists of
+     * a same vertex, only the last one is kept. Nothing is done if they are already sorted.
+     */
+    void
+    sortRows(std::vector<Vertex>& vertexes, std::vector<std::size_t>& offsets, std::vector<Vertex>& allOutlinks) {
+        if (std::adjacent_find(vertexes.begin(), vertexes.end(), std::greater_equal<Vertex>()) == vertexes.end())
+            return;
+
+        std::vector<std::size_t> rows(vertexes.size());
+        for (std::size_t i = 0; i < rows.size(); ++i)
+            rows[i] = i;
+        std::stable_sort(rows.begin(), rows.end(), [&vertexes](std::size_t a, std::size_t b) {
+            return vertexes[a] < vertexes[b];
+        });
+
+        std::vector<Vertex> sortedVertexes;
+        std::vector<std::size_t> sortedOffsets(1, 0);
+        std::vector<Vertex> sortedOutlinks;
+        sortedVertexes.reserve(vertexes.size());
+        sortedOffsets.reserve(offsets.size());
+        sortedOutlinks.reserve(allOutlinks.size());
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            if (r + 1 < rows.size() && vertexes[rows[r + 1]] == vertexes[rows[r]])
+                continue;       // Inconsistent input: keep the last list, as assigning them to a map would do
+
+            std::size_t row = rows[r];
+            sortedVertexes.push_back(vertexes[row]);
+            sortedOutlinks.insert(sortedOutlinks.end(),
+                                  allOutlinks.begin() + offsets[row], allOutlinks.begin() + offsets[row + 1]);
+            sortedOffsets.push_back(sortedOutlinks.size());
         }
-        AdjacencyList outlinks;
-        for (Vertex vx; iss >> vx; ) {
-            outlinks.push_back(vx);
+
+        vertexes.swap(sortedVertexes);
+        offsets.swap(sortedOffsets);
+        allOutlinks.swap(sortedOutlinks);
+    }
+
+
+    /*
+     * The distinct vertexes of the outlinks, by increasing id, from a sorted copy of them; and, if asked, the
+     * number of apparitions of each one. It takes memory by outlink, and not by id.
+     */
+    std::vector<Vertex>
+    distinctOutlinks(const std::vector<Vertex>& outlinks, parallel::ThreadPool& pool,
+                     std::vector<unsigned int>* frequencies) {
+        std::vector<Vertex> sorted(outlinks);
+        parallel::radix_sort(sorted, [](Vertex vx) { return vx; }, pool);
+
+        std::vector<Vertex> vertexes;
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            if (vertexes.empty() || vertexes.back() != sorted[i]) {
+                vertexes.push_back(sorted[i]);
+                if (frequencies)
+                    frequencies->push_back(0);
+            }
+            if (frequencies)
+                frequencies->back() += 1;
         }
-        assert(!comeSortedByVertex || algorithms::is_sorted(outlinks));
-        assert(algorithms::has_unique(outlinks));
+        return vertexes;
+    }
+
+}   // namespace
 
-        // The remainings in the line are simply ignored
 
-        innerGraph[vertex] = outlinks;
+//// Graph ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Graph::Graph(): lists(), outlinks(), sortedByVertex(true), mineability(2) {}
+
+
+Graph::Graph(const Graph& graph)
+: lists(graph.lists), outlinks(graph.outlinks), sortedByVertex(graph.sortedByVertex),
+  mineability(graph.mineability) {
+
+    for (std::size_t i = 0; i < lists.size(); ++i) {
+        lists[i].second.first = outlinks.data() + (graph.lists[i].second.first - graph.outlinks.data());
+        lists[i].second.last = lists[i].second.first + graph.lists[i].second.size();
+    }
+}
+
+
+Graph&
+Graph::operator=(const Graph& graph) {
+    if (this != &graph) {
+        Graph copy(graph);
+        lists.swap(copy.lists);         // Swapping vectors keeps their buffers, so the pointers are still valid
+        outlinks.swap(copy.outlinks);
+        sortedByVertex = copy.sortedByVertex;
+        mineability = copy.mineability;
+    }
+    return *this;
+}
+
+
+Graph::Graph(const std::string& fileName, bool comeSortedByVertex, unsigned int threadsCount)
+: lists(), outlinks(), sortedByVertex(comeSortedByVertex), mineability(0) {
+
+    assert(!fileName.empty());
+    assert(threadsCount >= 1);
+
+    const io::MappedFile file(fileName);
+
+    // Several chunks by thread, to balance the load between them
+    parallel::ThreadPool pool(threadsCount);
+    std::size_t chunksCount = (threadsCount == 1) ? 1 : 8 * threadsCount;
+    std::vector<std::size_t> bounds = io::line_aligned_bounds(file.data(), file.size(), chunksCount);
+
+    std::vector<GraphFileChunk> chunks(chunksCount);
+    pool.run(chunksCount, [&](std::size_t c) {
+        parseGraphFileChunk(file.data() + bounds[c], file.data() + bounds[c + 1], comeSortedByVertex, chunks[c]);
+    });
+
+    // The warnings are given in the order of the file, with the line numbers counted from its start
+    unsigned int linesBefore = 0;
+    for (std::size_t c = 0; c < chunksCount; ++c) {
+        for (std::vector<GraphFileChunk::Warning>::const_iterator it = chunks[c].warnings.begin();
+             it != chunks[c].warnings.end(); ++it) {
+            warnAboutInputFile(linesBefore + it->first, it->second, "ignoring line");
+        }
+        linesBefore += chunks[c].linesCount;
     }
+
+    // The chunks are merged in order, each one copied in parallel to its own precomputed place of the arrays
+    std::vector<Vertex> vertexes;
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Vertex> allOutlinks;
+    if (chunksCount == 1) {
+        vertexes.swap(chunks[0].vertexes);
+        offsets.swap(chunks[0].offsets);
+        allOutlinks.swap(chunks[0].outlinks);
+    } else {
+        std::vector<std::size_t> firstList(chunksCount + 1, 0), firstOutlink(chunksCount + 1, 0);
+        for (std::size_t c = 0; c < chunksCount; ++c) {
+            firstList[c + 1] = firstList[c] + chunks[c].vertexes.size();
+            firstOutlink[c + 1] = firstOutlink[c] + chunks[c].outlinks.size();
+        }
+        vertexes.resize(firstList[chunksCount]);
+        offsets.resize(firstList[chunksCount] + 1, firstOutlink[chunksCount]);
+        allOutlinks.resize(firstOutlink[chunksCount]);
+
+        pool.run(chunksCount, [&](std::size_t c) {
+            GraphFileChunk& chunk = chunks[c];
+            std::copy(chunk.vertexes.begin(), chunk.vertexes.end(), vertexes.begin() + firstList[c]);
+            std::copy(chunk.outlinks.begin(), chunk.outlinks.end(), allOutlinks.begin() + firstOutlink[c]);
+            for (std::size_t i = 0; i < chunk.vertexes.size(); ++i)
+                offsets[firstList[c] + i] = firstOutlink[c] + chunk.offsets[i];
+            GraphFileChunk().swap(chunk);       // Release the memory of the chunk as soon as possible
+        });
+    }
+
+    sortRows(vertexes, offsets, allOutlinks);
+    assign(vertexes, offsets, allOutlinks);
 }
 
 
-Graph::Graph(const GraphCluster& cluster): innerGraph(), sortedByVertex(false), mineability(2) {
+Graph::Graph(const GraphCluster& cluster): lists(), outlinks(), sortedByVertex(false), mineability(2) {
 
+    std::vector<Vertex> vertexes;
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Vertex> allOutlinks;
+    vertexes.reserve(cluster.listsCount());
+    offsets.reserve(cluster.listsCount() + 1);
     for (GraphCluster::const_iterator it = cluster.begin(); it != cluster.end(); ++it) {
-        innerGraph.insert(*it);
+        vertexes.push_back(it->first);
+        allOutlinks.insert(allOutlinks.end(), it->second.begin(), it->second.end());
+        offsets.push_back(allOutlinks.size());
     }
 
+    sortRows(vertexes, offsets, allOutlinks);
+    assign(vertexes, offsets, allOutlinks);
+
     assert(listsCount() == cluster.listsCount());
 }
 
 
+Graph::Graph(std::vector<Arc> arcs, unsigned int threadsCount)
+: lists(), outlinks(), sortedByVertex(true), mineability(0) {
+
+    assert(threadsCount >= 1);
+
+    // Sorted by outlink and then (stable) by vertex, i.e. by (vertex, outlink)
+    parallel::ThreadPool pool(threadsCount);
+    parallel::radix_sort(arcs, [](const Arc& arc) { return arc.second; }, pool);
+    parallel::radix_sort(arcs, [](const Arc& arc) { return arc.first; }, pool);
+    arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+
+    std::vector<Vertex> vertexes;
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Vertex> allOutlinks(arcs.size());
+    for (std::size_t i = 0; i < arcs.size(); ++i) {
+        if (i == 0 || arcs[i].first != arcs[i - 1].first) {     // A new adjacency list starts here
+            if (i > 0)
+                offsets.push_back(i);
+            vertexes.push_back(arcs[i].first);
+        }
+        allOutlinks[i] = arcs[i].second;
+    }
+    if (!arcs.empty())
+        offsets.push_back(arcs.size());
+    std::vector<Arc>().swap(arcs);      // Not needed anymore: free it before allocating the lists
+
+    assign(vertexes, offsets, allOutlinks);
+}
+
+
+void
+Graph::assign(const std::vector<Vertex>& vertexes,
+              const std::vector<std::size_t>& offsets,
+              std::vector<Vertex>& allOutlinks) {
+
+    assert(offsets.size() == vertexes.size() + 1);
+    assert(offsets.back() == allOutlinks.size());
+
+    outlinks.swap(allOutlinks);
+    outlinks.shrink_to_fit();
+
+    lists.resize(vertexes.size());
+    lists.shrink_to_fit();
+    for (std::size_t i = 0; i < vertexes.size(); ++i) {
+        assert(i == 0 || vertexes[i - 1] < vertexes[i]);
+
+        lists[i].first = vertexes[i];
+        lists[i].second = Outlinks(outlinks.data() + offsets[i], outlinks.data() + offsets[i + 1]);
+    }
+}
+
+
+Graph::const_iterator
+Graph::find(Vertex vertex) const {
+    const_iterator it = std::lower_bound(begin(), end(), vertex, [](const List& list, Vertex vx) {
+        return list.first < vx;
+    });
+    return (it != end() && it->first == vertex) ? it : end();
+}
+
+
 void
-Graph::rebuildForMining() {
+Graph::rebuildForMining(unsigned int threadsCount) {
     if (isMineable())
         return;
 
@@ -120,7 +396,7 @@ Graph::rebuildForMining() {
         mineability = 2;
     } else {
         rebuildForMiningExceptSorting();    // Required by VertexFrequencyComparer
-        rebuildForMining(VertexFrequencyComparer(*this));
+        rebuildForMining(VertexFrequencyComparer(*this, threadsCount), threadsCount);
     }
 
     assert(isMineable());
@@ -131,30 +407,41 @@ void
 Graph::rebuildForMiningExceptSorting() {
     if (mineability >= 1) return;
 
-    // Add self-loops and remove vertexes with 'trivial' (we need a better word) adjacency lists
-    for (iterator it = begin(); it != end();  ) {
+    // Add self-loops and remove vertexes with 'trivial' (we need a better word) adjacency lists, copying the
+    // lists kept to new arrays
+    std::vector<Vertex> vertexes;
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Vertex> allOutlinks;
+    vertexes.reserve(lists.size());
+    offsets.reserve(lists.size() + 1);
+    allOutlinks.reserve(outlinks.size() + lists.size());
+
+    for (const_iterator it = begin(); it != end(); ++it) {
         Vertex vertex = it->first;
-        AdjacencyList& outlinks = it->second;
+        const Outlinks& adjacency = it->second;
+
+        bool selfLoop = adjacency.size() >= 1 && !algorithms::is_found(adjacency, vertex);
+        if (adjacency.size() + (selfLoop ? 1 : 0) <= 1)
+            continue;
 
-        if (outlinks.size() >= 1 && !algorithms::is_found(outlinks, vertex)) {
+        if (selfLoop && sortedByVertex) {
             // If the graph was specified as already sorted by vertex, we don't want lose that property inserting
             // the self-loop without care.
-            if (sortedByVertex) {
-                outlinks.insert(std::upper_bound(outlinks.begin(), outlinks.end(), vertex), vertex);
-
-                assert(algorithms::is_sorted(outlinks));
-            } else {
-                outlinks.push_back(vertex);
-            }
-        }
-        if (outlinks.size() <= 1) {
-            iterator tmp = it;
-            ++it;
-            innerGraph.erase(tmp);
+            const Vertex* position = std::upper_bound(adjacency.begin(), adjacency.end(), vertex);
+            allOutlinks.insert(allOutlinks.end(), adjacency.begin(), position);
+            allOutlinks.push_back(vertex);
+            allOutlinks.insert(allOutlinks.end(), position, adjacency.end());
         } else {
-            ++it;
+            allOutlinks.insert(allOutlinks.end(), adjacency.begin(), adjacency.end());
+            if (selfLoop)
+                allOutlinks.push_back(vertex);
         }
+        assert(!sortedByVertex || std::is_sorted(allOutlinks.begin() + offsets.back(), allOutlinks.end()));
+
+        vertexes.push_back(vertex);
+        offsets.push_back(allOutlinks.size());
     }
+    assign(vertexes, offsets, allOutlinks);
 
     // Finally, ensure that this procedure can't be done twice needlessly
     mineability = 1;
@@ -176,19 +463,6 @@ Graph::nodesCount() const {
 }
 
 
-unsigned long
-Graph::arcsCount() const {
-    unsigned long arcs = 0;
-
-    for (const_iterator it = begin(); it != end(); ++it) {
-        arcs += it->second.size();      // Add the total of outlinks of each vertex
-    }
-
-    assert(!isMineable() || arcs >= listsCount() * 2);
-    return arcs;
-}
-
-
 std::ostream&
 operator<<(std::ostream& os, const Graph& graph) {
     // Comparing with Graph::print(), it ensures an short output, still with big graphs
@@ -246,9 +520,9 @@ void
 Graph::printAsArcs(std::ostream& os) const {
     for (const_iterator it = begin(); it != end(); ++it) {
         Vertex vertex = it->first;
-        const AdjacencyList& outlinks = it->second;
+        const Outlinks& outlinks = it->second;
 
-        for (Graph::AdjacencyList::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
+        for (Graph::Outlinks::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
             os << vertex << " " << *vxit << '\n';
         }
     }
@@ -257,74 +531,121 @@ Graph::printAsArcs(std::ostream& os) const {
 
 //// VertexFrequencyComparer //////////////////////////////////////////////////////////////////////////////////////////
 
-Graph::VertexFrequencyComparer::VertexFrequencyComparer(const Graph& graph): frequencies() {
+Graph::VertexFrequencyComparer::VertexFrequencyComparer(const Graph& graph, unsigned int threadsCount)
+: vertexes(), ranks() {
     assert(graph.mineability >= 1);
+    assert(threadsCount >= 1);
+
+    if (graph.outlinks.empty())
+        return;
 
-    // Count and save the number of apparitions of each Vertex in all the adjacency lists
-    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
-        const Graph::AdjacencyList& outlinks = it->second;
+    parallel::ThreadPool pool(threadsCount);
+    const Vertex maxVertex = *std::max_element(graph.outlinks.begin(), graph.outlinks.end());
 
-        for (Graph::AdjacencyList::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
-            frequencies[*vxit] += 1;
+    // With sparse ids, the histograms by id would take more memory than the outlinks themselves: only the distinct
+    // outlinks are ranked, counted from a sorted copy of them
+    if (static_cast<std::size_t>(maxVertex) + 1 > graph.outlinks.size() / threadsCount) {
+        std::vector<unsigned int> frequencies;
+        vertexes = distinctOutlinks(graph.outlinks, pool, &frequencies);
+
+        // The vertexes come by increasing id, and the sort is stable: ties by frequency stay sorted by id
+        std::vector<unsigned int> order(vertexes.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<unsigned int>(i);
         }
-    }
-}
+        parallel::radix_sort(order, [&frequencies](unsigned int i) {
+            return std::numeric_limits<unsigned int>::max() - frequencies[i];     // Decrescent orden by frequency
+        }, pool);
 
+        ranks.resize(order.size());
+        for (std::size_t rank = 0; rank < order.size(); ++rank) {
+            ranks[order[rank]] = static_cast<unsigned int>(rank);
+        }
+        return;
+    }
 
-bool
-Graph::VertexFrequencyComparer::operator()(Vertex vx1, Vertex vx2) const {
-    assert(frequencies.find(vx1) != frequencies.end());
-    assert(frequencies.find(vx2) != frequencies.end());
+    // A histogram of the apparitions of each Vertex in the adjacency lists by thread, over its own range of outlinks
+    std::vector<std::size_t> bounds = parallel::split_evenly(graph.outlinks.size(), threadsCount);
+    std::vector<std::vector<unsigned int> > histograms(threadsCount);
+    pool.run(threadsCount, [&](std::size_t t) {
+        histograms[t].assign(static_cast<std::size_t>(maxVertex) + 1, 0);
+        for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+            histograms[t][graph.outlinks[i]] += 1;
+        }
+    });
+
+    // ...added up, by ranges of vertexes, in the first one
+    std::vector<unsigned int>& frequencies = histograms[0];
+    std::vector<std::size_t> vertexBounds = parallel::split_evenly(frequencies.size(), threadsCount);
+    pool.run(threadsCount, [&](std::size_t t) {
+        for (std::size_t h = 1; h < histograms.size(); ++h) {
+            for (std::size_t vx = vertexBounds[t]; vx < vertexBounds[t + 1]; ++vx) {
+                frequencies[vx] += histograms[h][vx];
+            }
+        }
+    });
+    histograms.resize(1);
 
-    unsigned int freq1 = frequencies.find(vx1)->second;
-    unsigned int freq2 = frequencies.find(vx2)->second;
+    // The vertexes are taken by increasing id, and the sort is stable: ties by frequency stay sorted by id
+    std::vector<Vertex> order(frequencies.size());
+    for (std::size_t vx = 0; vx < order.size(); ++vx) {
+        order[vx] = static_cast<Vertex>(vx);
+    }
+    parallel::radix_sort(order, [&frequencies](Vertex vx) {
+        return std::numeric_limits<unsigned int>::max() - frequencies[vx];     // Decrescent orden by frequency
+    }, pool);
 
-    if (freq1 != freq2)
-        return freq1 > freq2;   // Decrescent orden by frequency...
-    else
-        return vx1 < vx2;   // ...then crescent orden by label
+    ranks.resize(order.size());
+    for (std::size_t rank = 0; rank < order.size(); ++rank) {
+        ranks[order[rank]] = static_cast<unsigned int>(rank);
+    }
 }
 
 
 //// RandomVertexPermutationComparer //////////////////////////////////////////////////////////////////////////////////
 
-Graph::RandomVertexPermutationComparer::RandomVertexPermutationComparer(const Graph& graph): permutation() {
+Graph::RandomVertexPermutationComparer::RandomVertexPermutationComparer(const Graph& graph, unsigned long long seed)
+: vertexes(), permutation() {
 
-    // First, save all vertexes that are part of the adjacency lists of the graph
-    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
-        const Graph::AdjacencyList& outlinks = it->second;
+    if (graph.outlinks.empty())
+        return;
 
-        for (Graph::AdjacencyList::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
-            permutation[*vxit] = *vxit;
-        }
+    // First, the vertexes that are part of the adjacency lists of the graph, in their places by increasing id
+    parallel::ThreadPool pool(1);
+    vertexes = distinctOutlinks(graph.outlinks, pool, NULL);
+    permutation.resize(vertexes.size());
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+        permutation[i] = static_cast<Vertex>(i);
     }
-    assert(permutation.size() == graph.nodesCount());
 
-    std::srand(std::time(0));   // Initialize seed
-
-    // Random shuffling.
-    // Loosely based in the 'possible implementation' for std::random_shuffle, from:
-    //   http://en.cppreference.com/w/cpp/algorithm/random_shuffle
-    // See also: Fisher-Yates shuffle
-    Permutation::reverse_iterator it = permutation.rbegin();
-    for (int i = permutation.size() - 1; i > 0; --i) {
-        Permutation::reverse_iterator randit = it;
-        std::advance(randit, std::rand() % (i + 1));
+    if (seed == 0)
+        seed = static_cast<unsigned long long>(std::time(NULL));
+    std::mt19937_64 random(seed);
+
+    // Random shuffling: Fisher-Yates shuffle. The index is drawn by rejection sampling, and not by a
+    // std::uniform_int_distribution, whose results depend on the standard library, so a seed gives the same
+    // permutation everywhere; a plain modulo would favour the lowest indexes
+    for (std::size_t i = permutation.size() - 1; i > 0; --i) {
+        const uint64_t bound = static_cast<uint64_t>(i) + 1;
+        const uint64_t threshold = (uint64_t(0) - bound) % bound;     // 2^64 mod bound: the incomplete last range
+        uint64_t draw;
+        do {
+            draw = random();
+        } while (draw < threshold);
+        std::swap(permutation[i], permutation[draw % bound]);
+    }
 
-        std::swap(it->second, randit->second);
-        ++it;
+    // With dense ids, the places are kept by id, so finding them doesn't need a search
+    const Vertex maxVertex = vertexes.back();
+    if (static_cast<std::size_t>(maxVertex) + 1 <= graph.outlinks.size()) {
+        Permutation byId(static_cast<std::size_t>(maxVertex) + 1, 0);
+        for (std::size_t i = 0; i < vertexes.size(); ++i) {
+            byId[vertexes[i]] = permutation[i];
+        }
+        permutation.swap(byId);
+        std::vector<Vertex>().swap(vertexes);
     }
 }
 
 
-bool
-Graph::RandomVertexPermutationComparer::operator()(Vertex vx1, Vertex vx2) const {
-    assert(permutation.find(vx1) != permutation.end());
-    assert(permutation.find(vx2) != permutation.end());
-
-    // The next is logically the same as:
-    //     permutation[vx1] < permutation[vx2]
-    return permutation.find(vx1)->second < permutation.find(vx2)->second;
-}
-
 }   // namespace odsg
@@ -1,6 +1,7 @@
 #ifndef SRC_GRAPH_HPP_INCLUDED
 #define SRC_GRAPH_HPP_INCLUDED
 
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
 #include <cstddef>      // std::size_t
 #include <string>
 #include <vector>
@@ -12,6 +13,7 @@
 #include      "Vertex.hpp"
 #include "WGraphTypes.hpp"
 #include    "WedgeMap.hpp"
+#include "utils/parallel.hpp"
 
 namespace odsg {
 
@@ -19,7 +21,12 @@ namespace odsg {
 class GraphCluster;
 
 /*
- * Graph objects are managed as a map of vertexes and their respective adjacency lists (aka outlinks).
+ * Graph objects are managed as a collection of vertexes and their respective adjacency lists (aka outlinks).
+ *
+ * They are stored in compressed sparse rows: all the outlinks in a single contiguous array, list after list, and the
+ * lists (their vertex and the range of their outlinks) in another one, sorted by vertex; the index of a list in that
+ * array is the dense index of its vertex. Compared with a map of vectors, there is no tree node nor heap block by
+ * list, iterating the graph is a linear scan, and finding a list is a binary search over a contiguous array.
  *
  * For all the constructors is assumed that the input data is 'consistent' (or 'without duplication'), e.g.
  * no multiple adjacency lists for a same vertex, or no duplicated vertexes inside the same adjacency list.
@@ -29,8 +36,41 @@ class Graph {
 public:
     //// Types ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    typedef std::vector<Vertex> AdjacencyList;
-    typedef std::map<Vertex, AdjacencyList>::const_iterator const_iterator;
+    typedef std::vector<Vertex> AdjacencyList;      // To build graphs; stored lists are iterated as Outlinks
+    typedef std::pair<Vertex, Vertex> Arc;          // (vertex, outlink)
+
+    /*
+     * The outlinks of a stored adjacency list: a read-only range of the outlinks array, that can be iterated like
+     * an AdjacencyList. Any AdjacencyList can be seen as Outlinks too, while it isn't modified.
+     */
+    struct Outlinks {
+        typedef Vertex value_type;
+        typedef const Vertex* const_iterator;
+
+        const Vertex* first;
+        const Vertex* last;
+
+        Outlinks(): first(NULL), last(NULL) {}
+        Outlinks(const Vertex* f, const Vertex* l): first(f), last(l) {}
+        Outlinks(const AdjacencyList& list): first(list.data()), last(list.data() + list.size()) {}
+
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+        const Vertex* data() const { return first; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+        bool empty() const { return first == last; }
+        Vertex operator[](std::size_t i) const { return first[i]; }
+    };
+
+    /*
+     * An adjacency list: its vertex and its outlinks, with the same interface of a std::pair.
+     */
+    struct List {
+        Vertex first;
+        Outlinks second;
+    };
+
+    typedef const List* const_iterator;
 
 
     //// Constructors /////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,8 +89,13 @@ public:
      * responsibility of the caller ensuring it; it's exposed as a performance boost, as it lets to skip the slow
      * sorting phase in Graph::rebuildForMining(). In case of doubt, don't set it, otherwise it will trigger
      * undefined behaviour.
+     *
+     * The file is mapped in memory and split in ranges of whole lines, parsed in a pool of threadsCount threads; the
+     * graph, and the warnings about malformed lines, don't depend on the number of threads.
      */
-    explicit Graph(const std::string& fileName, bool comeSortedByVertex=false);     // It can throw an exception
+    explicit Graph(const std::string& fileName,
+                   bool comeSortedByVertex=false,
+                   unsigned int threadsCount=1);        // It can throw an exception
 
     /*
      * Built a graph from a cluster.
@@ -65,11 +110,24 @@ public:
     template<typename ContainerT>
     explicit Graph(const std::map<Vertex, ContainerT>&);
 
+    /*
+     * Built a graph from a list of arcs, in any order: the adjacency list of each vertex gathers its outlinks, sorted
+     * by id (so the graph is sorted by vertex) and without duplicates. The arcs are sorted by a parallel radix sort
+     * in a pool of threadsCount threads; the graph doesn't depend on the number of threads. The arcs are taken by
+     * value, as they are sorted in place: move them in when they aren't needed anymore.
+     */
+    explicit Graph(std::vector<Arc> arcs, unsigned int threadsCount=1);
+
+    Graph(const Graph&);
+    Graph& operator=(const Graph&);     // The lists point into the outlinks array, so both need some fixing
+
 
     //// Iterators ////////////////////////////////////////////////////////////////////////////////////////////////
 
-    const_iterator begin() const { return innerGraph.begin(); }
-    const_iterator end() const { return innerGraph.end(); }
+    const_iterator begin() const { return lists.data(); }
+    const_iterator end() const { return lists.data() + lists.size(); }
+
+    const_iterator find(Vertex) const;      // end() if the vertex doesn't have an adjacency list
 
 
     //// Mutators /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -81,18 +139,20 @@ public:
      * The most important property of a mineable graph is that all its adjacency lists are sorted according to a
      * strict total order, thus ensuring that a dag built from it will not have cycles.
      *
-     * The form without parameters sorts the adjacency lists only when it's required (e.g. it's skipped if the graph
-     * was built from a file with its data already sorted) and using Graph::VertexFrequencyComparer.
+     * The form without comparer sorts the adjacency lists only when it's required (e.g. it's skipped if the graph
+     * was built from a file with its data already sorted) and using Graph::VertexFrequencyComparer, whose counting
+     * takes threadsCount threads too.
      * For the second overloaded form, the sorting is always (re)done; the given comparer must define a strict
-     * ordering between the vertexes.
+     * ordering between the vertexes. The adjacency lists are sorted in a pool of threadsCount threads, so the
+     * comparer must be safe to call concurrently; the result doesn't depend on the number of threads.
      *
      * See Graph::VertexComparer and Graph::VertexFrequencyComparer for some already available comparers.
      */
-    void rebuildForMining();
+    void rebuildForMining(unsigned int threadsCount=1);
 
     template<typename Comparer>
 //==============================================================================    
-    void rebuildForMining(Comparer);
+    void rebuildForMining(Comparer, unsigned int threadsCount=1);
 
     /*
      * Let to trigger independently the rebuilding for mining except the final sorting of the adjacency lists.
@@ -115,13 +175,13 @@ public:
      *
      * - VertexComparer lets to sort the adjacency lists by increasing Vertex id.
      * - VertexFrequencyComparer lets to sort the adjacency lists by decreasing frequency of apparition in the
-     *   adjacency lists (i.e. the inlinks count of each Vertex).
+     *   adjacency lists (i.e. the inlinks count of each Vertex), and then by increasing id.
      *   To use it, Graph::rebuildForMiningExceptSorting() must have been called previously, otherwise it will trigger
      *   undefined behaviour.
-     * - RandomVertexPermutationComparer matches each Vertex with another Vertex choosed randomly and then it sorts
-     *   by increasing id of the matched Vertex. It lets to simulate that the ids were assigned originally to each
-     *   Vertex in a random way, trying with it to provide a kind of 'middle point' to compare the impact of different
-     *   sorting strategies in the quantity and quality of the mined dense subgraphs.
+     * - RandomVertexPermutationComparer matches each Vertex with another Vertex choosed randomly (by a given seed)
+     *   and then it sorts by increasing id of the matched Vertex. It lets to simulate that the ids were assigned
+     *   originally to each Vertex in a random way, trying with it to provide a kind of 'middle point' to compare the
+     *   impact of different sorting strategies in the quantity and quality of the mined dense subgraphs.
      *   To use it, Graph::rebuildForMiningExceptSorting() must have been called previously too.
      */
     struct VertexComparer;
@@ -131,11 +191,11 @@ public:
 
     //// Inspectors ///////////////////////////////////////////////////////////////////////////////////////////////
 
-    bool empty() const { return innerGraph.empty(); }
+    bool empty() const { return lists.empty(); }
 
-    std::size_t listsCount() const { return innerGraph.size(); }
+    std::size_t listsCount() const { return lists.size(); }
     std::size_t nodesCount() const;     // It can be slow
-    unsigned long arcsCount() const;
+    unsigned long arcsCount() const { return static_cast<unsigned long>(outlinks.size()); }
 
     bool isMineable() const { return mineability == 2; }
     bool isSortedByVertex() const { return sortedByVertex; }
@@ -169,7 +229,10 @@ public:
 
 protected:
 
-    std::map<Vertex, AdjacencyList> innerGraph;
+    friend class GraphSnapshot;         // Snapshots are loaded straight to the arrays
+
+    std::vector<List> lists;            // By increasing vertex
+    std::vector<Vertex> outlinks;       // All the outlinks, list after list
 
     /*
      * Knowing than the adjacency lists are currently sorted by Vertex lets us improve the performance of the
@@ -183,10 +246,18 @@ protected:
 
     //// Internal helpers /////////////////////////////////////////////////////////////////////////////////////////
 
-    typedef std::map<Vertex, AdjacencyList>::iterator iterator;
+    /*
+     * Replace all the adjacency lists: the i-th one is vertexes[i] (sorted and without duplicates) with the outlinks
+     * [offsets[i], offsets[i + 1]) of allOutlinks, that is swapped in.
+     */
+    void assign(const std::vector<Vertex>& vertexes,
+                const std::vector<std::size_t>& offsets,
+                std::vector<Vertex>& allOutlinks);
+
+    Vertex* outlinksOf(const List& list) { return outlinks.data() + (list.second.first - outlinks.data()); }
 
-    iterator begin() { return innerGraph.begin(); }
-    iterator   end() { return   innerGraph.end(); }
+    template<typename Comparer>
+    void sortOutlinks(const Comparer&, unsigned int threadsCount);
 
     //// Helpers for print() and dump()
     void printAsAdjacencyLists(std::ostream&) const;
@@ -197,11 +268,20 @@ protected:
 //// Graph constructors ///////////////////////////////////////////////////////////////////////////////////////////////
 
 template<typename ContainerT>
-Graph::Graph(const std::map<Vertex, ContainerT>& m): innerGraph(), sortedByVertex(false), mineability(0) {
+Graph::Graph(const std::map<Vertex, ContainerT>& m): lists(), outlinks(), sortedByVertex(false), mineability(0) {
+
+    std::vector<Vertex> vertexes;
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Vertex> allOutlinks;
+    vertexes.reserve(m.size());
+    offsets.reserve(m.size() + 1);
 
     for (typename std::map<Vertex, ContainerT>::const_iterator it = m.begin(); it != m.end(); ++it) {
-        innerGraph[it->first] = AdjacencyList(it->second.begin(), it->second.end());
+        vertexes.push_back(it->first);
+        allOutlinks.insert(allOutlinks.end(), it->second.begin(), it->second.end());
+        offsets.push_back(allOutlinks.size());
     }
+    assign(vertexes, offsets, allOutlinks);
 }
 
 
@@ -212,50 +292,120 @@ struct Graph::VertexComparer: public std::binary_function<Vertex, Vertex, bool>
 };
 
 
+/*
+ * The order by frequency is computed once, as the rank of each vertex in it, so comparing two vertexes is comparing
+ * two integers. When the ids are dense enough, the ranks are kept by vertex id, up to the biggest id in the adjacency
+ * lists; else, only for the distinct outlinks, whose ranks are found by binary search, so sparse ids (e.g. any 32-bit
+ * hash) don't take memory by id. The frequencies are counted, and the vertexes ranked, in a pool of threadsCount
+ * threads.
+ */
 struct Graph::VertexFrequencyComparer: public std::binary_function<Vertex, Vertex, bool> {
-    explicit VertexFrequencyComparer(const Graph&);
-    bool operator()(Vertex, Vertex) const;
+    explicit VertexFrequencyComparer(const Graph&, unsigned int threadsCount=1);
+    bool operator()(Vertex vx1, Vertex vx2) const;
 private:
-    std::map<Vertex, unsigned int> frequencies;
+    std::vector<Vertex> vertexes;       // The distinct outlinks, by increasing id; empty if the ranks are by id
+    std::vector<unsigned int> ranks;    // By vertex: its place by decreasing frequency, and then by increasing id
+
+    unsigned int rankOf(Vertex) const;
 };
 
+inline bool
+Graph::VertexFrequencyComparer::operator()(Vertex vx1, Vertex vx2) const {
+    return rankOf(vx1) < rankOf(vx2);
+}
+
+inline unsigned int
+Graph::VertexFrequencyComparer::rankOf(Vertex vx) const {
+    if (vertexes.empty()) {
+        assert(vx < ranks.size());
+        return ranks[vx];
+    }
+
+    std::vector<Vertex>::const_iterator it = std::lower_bound(vertexes.begin(), vertexes.end(), vx);
+    assert(it != vertexes.end() && *it == vx);
+    return ranks[static_cast<std::size_t>(it - vertexes.begin())];
+}
+
 
+/*
+ * The permutation is drawn by a Fisher-Yates shuffle of the distinct outlinks of the adjacency lists, from a
+ * std::mt19937_64 generator; the same seed gives the same permutation. Without an explicit seed, a different one is
+ * taken in each run. Like the ranks of VertexFrequencyComparer, the places in the permutation are kept by vertex id
+ * when the ids are dense enough, or else only for the distinct outlinks, found by binary search.
+ */
 struct Graph::RandomVertexPermutationComparer: public std::binary_function<Vertex, Vertex, bool> {
-    typedef std::map<Vertex, Vertex> Permutation;
+    typedef std::vector<Vertex> Permutation;
 
-    explicit RandomVertexPermutationComparer(const Graph&);
-    bool operator()(Vertex, Vertex) const;
+    explicit RandomVertexPermutationComparer(const Graph&, unsigned long long seed=0);
+    bool operator()(Vertex vx1, Vertex vx2) const;
 private:
-    Permutation permutation;
+    std::vector<Vertex> vertexes;   // The distinct outlinks, by increasing id; empty if the permutation is by id
+    Permutation permutation;        // By vertex: its place in the random order
+
+    Vertex placeOf(Vertex) const;
 };
 
+inline bool
+Graph::RandomVertexPermutationComparer::operator()(Vertex vx1, Vertex vx2) const {
+    return placeOf(vx1) < placeOf(vx2);
+}
+
+inline Vertex
+Graph::RandomVertexPermutationComparer::placeOf(Vertex vx) const {
+    if (vertexes.empty()) {
+        assert(vx < permutation.size());
+        return permutation[vx];
+    }
+
+    std::vector<Vertex>::const_iterator it = std::lower_bound(vertexes.begin(), vertexes.end(), vx);
+    assert(it != vertexes.end() && *it == vx);
+    return permutation[static_cast<std::size_t>(it - vertexes.begin())];
+}
+
 
 //// Graph mutators ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 template<typename Comparer>
 inline void
-Graph::rebuildForMining(Comparer comparer) {
+Graph::rebuildForMining(Comparer comparer, unsigned int threadsCount) {
     rebuildForMiningExceptSorting();
 
-    for (iterator it = begin(); it != end(); ++it) {
-        std::sort(it->second.begin(), it->second.end(), comparer);
-    }
+    sortOutlinks(comparer, threadsCount);
     sortedByVertex = false;
     mineability = 2;
 }
 
 template<>      // Template specialization for Graph::VertexComparer in order to update sortedByVertex
 inline void
-Graph::rebuildForMining<Graph::VertexComparer>(Graph::VertexComparer comparer) {
+Graph::rebuildForMining<Graph::VertexComparer>(Graph::VertexComparer comparer, unsigned int threadsCount) {
     rebuildForMiningExceptSorting();
 
-    for (iterator it = begin(); it != end(); ++it) {
-        std::sort(it->second.begin(), it->second.end(), comparer);
-    }
+    sortOutlinks(comparer, threadsCount);
     sortedByVertex = true;
     mineability = 2;
 }
 
+template<typename Comparer>
+inline void
+Graph::sortOutlinks(const Comparer& comparer, unsigned int threadsCount) {
+    assert(threadsCount >= 1);
+
+    // Several chunks of lists by thread, to balance the load between them; each list is sorted by a single thread
+    parallel::ThreadPool pool(threadsCount);
+    std::size_t chunksCount = (threadsCount == 1) ? 1 : 8 * threadsCount;
+    std::vector<std::size_t> bounds = parallel::split_evenly(lists.size(), chunksCount);
+
+    // std::sort copies its comparer over and over: it gets only a reference to the one given, however big it is
+    const auto compare = [&comparer](Vertex vx1, Vertex vx2) { return comparer(vx1, vx2); };
+    pool.run(chunksCount, [&](std::size_t c) {
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+            Vertex* first = outlinksOf(lists[i]);
+            std::sort(first, first + lists[i].second.size(), compare);
+        }
+    });
+}
+
+
 
 }       // namespace odsg
 #endif  // SRC_GRAPH_HPP_INCLUDED
@@ -35,6 +35,11 @@ public:
 
 //==============================================================================    
     GraphCluster(const Graph* graph): innerCluster(), ptr_graph(graph) {}
+
+    GraphCluster(const Graph* graph,
+                 std::vector<Graph::const_iterator>::const_iterator first,
+                 std::vector<Graph::const_iterator>::const_iterator last)
+    : innerCluster(first, last), ptr_graph(graph) {}
     
     GraphCluster( const GraphCluster& );
 //==============================================================================
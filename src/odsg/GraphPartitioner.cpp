@@ -1,8 +1,15 @@
 #include "GraphPartitioner.hpp"
 
 #include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <algorithm>    // std::sort, std::unique
+#include <ctime>        // std::time
+#include <map>
+#include <ostream>
+#include <unordered_map>
+#include <utility>      // std::pair
 
 #include "utils/algorithms.hpp"
+#include "utils/parallel.hpp"
 #include "Graph.hpp"
 #include "GraphCluster.hpp"
 
@@ -36,71 +43,439 @@ GraphPartitioner::next(unsigned long minClusterArcsCount) {
 }
 
 
+namespace {     // Put here general, global definitions limited to this file
+
+    bool
+    byDecreasingArcsCount(const std::pair<unsigned long, GraphCluster>& a,
+                          const std::pair<unsigned long, GraphCluster>& b) {
+        return a.first > b.first;
+    }
+
+    /*
+     * Split a cluster in parts of at most maxArcsCount arcs, appending them to parts. The lists are spread over
+     * the parts by a shingles signature, so lists with similar outlinks tend to stay together; parts still too
+     * big are split again with a new seed. If re-hashing doesn't make progress, the lists are cut in order.
+     */
+    void
+    splitCluster(const Graph* graph, const GraphCluster& cluster, unsigned long arcsCount, unsigned long maxArcsCount,
+                 unsigned long long seed, std::vector<std::pair<unsigned long, GraphCluster> >& parts) {
+
+        if (arcsCount <= maxArcsCount || cluster.listsCount() == 1) {
+            parts.push_back(std::make_pair(arcsCount, cluster));
+            return;
+        }
+
+        std::size_t partsCount = static_cast<std::size_t>((arcsCount + maxArcsCount - 1) / maxArcsCount);
+        std::vector<GraphCluster> split(partsCount, GraphCluster(graph));
+        std::vector<unsigned long> splitArcs(partsCount, 0);
+
+        const Shingles shingles(1, 1, seed);
+        for (GraphCluster::const_iterator it = cluster.begin(); it != cluster.end(); ++it) {
+            std::size_t part = shingles.sign(it->second) % partsCount;
+            split[part].insert(*it.base());
+            splitArcs[part] += it->second.size();
+        }
+
+        bool progress = true;
+        for (std::size_t part = 0; part < partsCount; ++part)
+            progress = progress && split[part].listsCount() < cluster.listsCount();
+
+        if (!progress && seed >= 3) {      // Give up re-hashing after some tries
+            GraphCluster piece(graph);
+            unsigned long pieceArcs = 0;
+            for (GraphCluster::const_iterator it = cluster.begin(); it != cluster.end(); ++it) {
+                if (!piece.empty() && pieceArcs + it->second.size() > maxArcsCount) {
+                    parts.push_back(std::make_pair(pieceArcs, piece));
+                    piece = GraphCluster(graph);
+                    pieceArcs = 0;
+                }
+                piece.insert(*it.base());
+                pieceArcs += it->second.size();
+            }
+            parts.push_back(std::make_pair(pieceArcs, piece));
+            return;
+        }
+
+        for (std::size_t part = 0; part < partsCount; ++part) {
+            if (!split[part].empty())
+                splitCluster(graph, split[part], splitArcs[part], maxArcsCount, seed + 1, parts);
+        }
+    }
+}
+
+
+std::vector<GraphCluster>
+GraphPartitioner::pack(unsigned long minClusterArcsCount, unsigned long maxClusterArcsCount) {
+    assert(graph->isMineable());
+    assert(minClusterArcsCount <= maxClusterArcsCount);
+
+    // Split the oversized clusters, keeping apart the undersized ones
+    std::vector<std::pair<unsigned long, GraphCluster> > packed, small;
+    for (GraphCluster cluster = getNext(); !cluster.empty(); cluster = getNext()) {
+        std::vector<std::pair<unsigned long, GraphCluster> > parts;
+        splitCluster(graph, cluster, cluster.arcsCount(), maxClusterArcsCount, 0, parts);
+
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            if (parts[i].first >= minClusterArcsCount)
+                packed.push_back(parts[i]);
+            else
+                small.push_back(parts[i]);
+        }
+    }
+
+    // Best-fit decreasing of the undersized clusters into bins of maxClusterArcsCount arcs. The open bins are kept
+    // by free capacity, so the tightest one with room for each cluster is found in logarithmic time
+    std::stable_sort(small.begin(), small.end(), byDecreasingArcsCount);
+    std::vector<std::pair<unsigned long, GraphCluster> > bins;
+    std::multimap<unsigned long, std::size_t> binsByFreeArcs;
+    for (std::size_t i = 0; i < small.size(); ++i) {
+        std::size_t bin = bins.size();
+        std::multimap<unsigned long, std::size_t>::iterator tightest = binsByFreeArcs.lower_bound(small[i].first);
+        if (tightest != binsByFreeArcs.end()) {
+            bin = tightest->second;
+            binsByFreeArcs.erase(tightest);
+        } else {
+            bins.push_back(std::make_pair(0UL, GraphCluster(graph)));
+        }
+
+        bins[bin].first += small[i].first;
+        bins[bin].second.merge(small[i].second);
+        if (bins[bin].first < maxClusterArcsCount)
+            binsByFreeArcs.insert(std::make_pair(maxClusterArcsCount - bins[bin].first, bin));
+    }
+    packed.insert(packed.end(), bins.begin(), bins.end());
+
+    std::stable_sort(packed.begin(), packed.end(), byDecreasingArcsCount);
+    std::vector<GraphCluster> clusters;
+    clusters.reserve(packed.size());
+    for (std::size_t i = 0; i < packed.size(); ++i)
+        clusters.push_back(packed[i].second);
+    return clusters;
+}
+
+
+//// SortedBuckets //////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+SortedBuckets::build(const Graph* graph, const std::vector<Key>& keys, unsigned int threadsCount) {
+    assert(keys.size() == graph->listsCount());
+    assert(threadsCount >= 1);
+
+    struct KeyedList {
+        Key key;
+        unsigned int list;
+    };
+
+    std::vector<KeyedList> keyed(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keyed[i].key = keys[i];
+        keyed[i].list = static_cast<unsigned int>(i);
+    }
+
+    // Threads pay off only for big graphs; small ones (the common case, one by cluster) are sorted in place
+    parallel::ThreadPool pool(keys.size() < (1 << 16) ? 1 : threadsCount);
+    parallel::radix_sort(keyed, [](const KeyedList& kl) { return kl.key; }, pool);
+
+    std::vector<Graph::const_iterator> byIndex;
+    byIndex.reserve(keys.size());
+    for (Graph::const_iterator it = graph->begin(); it != graph->end(); ++it)
+        byIndex.push_back(it);
+
+    lists.clear();
+    lists.reserve(keys.size());
+    bounds.assign(1, 0);
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        if (i > 0 && keyed[i].key != keyed[i - 1].key)
+            bounds.push_back(i);
+        lists.push_back(byIndex[keyed[i].list]);
+    }
+    if (!lists.empty())
+        bounds.push_back(lists.size());
+    nextBucket = 0;
+}
+
+
+GraphCluster
+SortedBuckets::next(const Graph* graph) {
+    if (nextBucket == bucketsCount())
+        return GraphCluster();      // An empty cluster indicates to the caller to have reached the end
+
+    std::size_t bucket = nextBucket++;
+    assert(bounds[bucket] < bounds[bucket + 1]);
+    return GraphCluster(graph, lists.begin() + bounds[bucket], lists.begin() + bounds[bucket + 1]);
+}
+
+
 //// GraphPartitionerByInitialOutlink /////////////////////////////////////////////////////////////////////////////////
 
-GraphPartitionerByInitialOutlink::GraphPartitionerByInitialOutlink(const Graph* g)
+GraphPartitionerByInitialOutlink::GraphPartitionerByInitialOutlink(const Graph* g, unsigned int threadsCount)
 : GraphPartitioner(g), initialOutlinks() {
 
     assert(graph->isMineable());
     // The case of graph being empty is managed too, implicitly
 
+    std::vector<SortedBuckets::Key> keys;
+    keys.reserve(graph->listsCount());
     for (Graph::const_iterator it = graph->begin(); it != graph->end(); ++it) {
-        const Graph::AdjacencyList& outlinks = it->second;
+        const Graph::Outlinks& outlinks = it->second;
         assert(!outlinks.empty());
 
-        initialOutlinks[outlinks[0]].insert(it);
+        keys.push_back(outlinks[0]);
     }
-    assert(initialOutlinks.size() <= graph->listsCount());
-
-    nextInitialOutlink = initialOutlinks.begin();
+    initialOutlinks.build(graph, keys, threadsCount);
+    assert(initialOutlinks.bucketsCount() <= graph->listsCount());
 }
 
 
 GraphCluster
 GraphPartitionerByInitialOutlink::getNext() {
-    if (nextInitialOutlink == initialOutlinks.end())
-        return GraphCluster();      // An empty cluster indicates to the caller to have reached the end
+    return initialOutlinks.next(graph);
+}
 
-    std::map<Vertex, GraphCluster>::const_iterator currentInitialOutlink = nextInitialOutlink;
-    ++nextInitialOutlink;
 
-    assert(!currentInitialOutlink->second.empty());
-    return currentInitialOutlink->second;
+//// GraphPartitionerBySignature //////////////////////////////////////////////////////////////////////////////////////
+
+namespace {     // Put here general, global definitions limited to this file
+
+    struct BucketSize {
+        std::size_t lists;
+        unsigned long arcs;
+    };
+
+    std::unordered_map<SortedBuckets::Key, BucketSize>
+    bucketsSizes(const std::vector<Graph::const_iterator>& lists, const std::vector<SortedBuckets::Key>& keys) {
+        std::unordered_map<SortedBuckets::Key, BucketSize> sizes;
+        for (std::size_t i = 0; i < lists.size(); ++i) {
+            BucketSize& size = sizes[keys[i]];      // Value-initialized to zeros when new
+            size.lists++;
+            size.arcs += lists[i]->second.size();
+        }
+        return sizes;
+    }
+
+    /*
+     * Number of buckets by size range: 1, 2-3, 4-7, 8-15...
+     */
+    std::vector<std::size_t>
+    bucketsHistogram(const std::vector<std::size_t>& sizes) {
+        std::vector<std::size_t> histogram;
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            std::size_t range = 0;
+            while ((sizes[i] >> (range + 1)) > 0)
+                ++range;
+            if (histogram.size() <= range)
+                histogram.resize(range + 1, 0);
+            histogram[range]++;
+        }
+        return histogram;
+    }
 }
 
 
-//// GraphPartitionerBySignature //////////////////////////////////////////////////////////////////////////////////////
+GraphPartitionerBySignature::GraphPartitionerBySignature(const Graph* g,
+                                                         std::size_t maxBucketLists,
+                                                         unsigned long maxBucketArcs,
+                                                         unsigned long long seed,
+                                                         unsigned int threadsCount)
+: GraphPartitioner(g), signatures(), initialBucketsSizes(), levels(0) {
 
-GraphPartitionerBySignature::GraphPartitionerBySignature(const Graph* g)
-: GraphPartitioner(g), signatures() {
+    static const unsigned int MAX_LEVELS = 16;
 
     assert(graph->isMineable());
     // The case of graph being empty is managed too, implicitly
 
-    Shingles shingle;
+    if (seed == 0)
+        seed = static_cast<unsigned long long>(std::time(NULL));
+    const Shingles shingle(1, 1, seed);
+
+    std::vector<Graph::const_iterator> lists;
+    std::vector<SortedBuckets::Key> keys;
+    lists.reserve(graph->listsCount());
+    keys.reserve(graph->listsCount());
     for (Graph::const_iterator it = g->begin(); it != g->end(); ++it) {
-        const Graph::AdjacencyList& outlinks = it->second;
+        const Graph::Outlinks& outlinks = it->second;
         assert(!outlinks.empty());
 
-        Shingles::Signature signature = shingle.sign(outlinks);
-        signatures[signature].insert(it);
+        lists.push_back(it);
+        keys.push_back(shingle.sign(outlinks));
+    }
+
+    std::unordered_map<SortedBuckets::Key, BucketSize> sizes = bucketsSizes(lists, keys);
+    for (std::unordered_map<SortedBuckets::Key, BucketSize>::const_iterator it = sizes.begin(); it != sizes.end(); ++it)
+        initialBucketsSizes.push_back(it->second.lists);
+
+    const bool limited = maxBucketLists > 0 || maxBucketArcs > 0;
+    while (limited && levels < MAX_LEVELS) {
+        const Shingles resigning(1 + levels % 2, 1, seed + levels + 1);
+
+        bool oversized = false;
+        for (std::size_t i = 0; i < lists.size(); ++i) {
+            const BucketSize& size = sizes.find(keys[i])->second;
+            if ((maxBucketLists > 0 && size.lists > maxBucketLists)
+                || (maxBucketArcs > 0 && size.arcs > maxBucketArcs)) {
+                // Mixing the old key in keeps the lists of different buckets apart
+                keys[i] = keys[i] * 2654435761U ^ resigning.sign(lists[i]->second);
+                oversized = true;
+            }
+        }
+        if (!oversized)
+            break;
+        ++levels;
+
+        std::size_t bucketsBefore = sizes.size();
+        sizes = bucketsSizes(lists, keys);
+        if (sizes.size() == bucketsBefore)
+            break;      // Nothing was split
     }
-    assert(signatures.size() <= graph->listsCount());
 
-    nextSignature = signatures.begin();
+    signatures.build(graph, keys, threadsCount);
+    assert(signatures.bucketsCount() <= graph->listsCount());
+}
+
+
+void
+GraphPartitionerBySignature::printBucketsReport(std::ostream& os) const {
+    std::vector<std::size_t> finalBucketsSizes;
+    for (std::size_t bucket = 0; bucket < signatures.bucketsCount(); ++bucket)
+        finalBucketsSizes.push_back(signatures.bucketSize(bucket));
+
+    std::vector<std::size_t> before = bucketsHistogram(initialBucketsSizes);
+    std::vector<std::size_t> after = bucketsHistogram(finalBucketsSizes);
+    if (before.size() < after.size())
+        before.resize(after.size(), 0);
+    after.resize(before.size(), 0);
+
+    os << "Signature buckets by lists: " << initialBucketsSizes.size() << " before and " << finalBucketsSizes.size()
+       << " after " << levels << " re-signing levels\n";
+    for (std::size_t range = 0; range < before.size(); ++range) {
+        std::size_t first = std::size_t(1) << range;
+        os << "  " << first;
+        if (range > 0)
+            os << '-' << 2 * first - 1;
+        os << ": " << before[range] << " / " << after[range] << '\n';
+    }
 }
 
 
 GraphCluster
 GraphPartitionerBySignature::getNext() {
-    if (nextSignature == signatures.end())
+    return signatures.next(graph);
+}
+
+
+//// GraphPartitionerByTwoLevelShingles /////////////////////////////////////////////////////////////////////////////
+
+namespace {     // Put here general, global definitions limited to this file
+
+    /*
+     * Root of the tree of a list in a union-find forest, halving the path on the way.
+     */
+    std::size_t
+    findRoot(std::vector<std::size_t>& parents, std::size_t list) {
+        while (parents[list] != list) {
+            parents[list] = parents[parents[list]];
+            list = parents[list];
+        }
+        return list;
+    }
+}
+
+
+GraphPartitionerByTwoLevelShingles::GraphPartitionerByTwoLevelShingles(const Graph* g,
+                                                                       unsigned int shingleSize,
+                                                                       unsigned int signaturesCount,
+                                                                       unsigned long long seed,
+                                                                       unsigned int threadsCount)
+: GraphPartitioner(g), clusters() {
+
+    assert(graph->isMineable());
+    assert(threadsCount >= 1);
+    // The case of graph being empty is managed too, implicitly
+
+    if (seed == 0)
+        seed = static_cast<unsigned long long>(std::time(NULL));
+    const Shingles firstLevel(shingleSize, signaturesCount, seed);
+    const Shingles secondLevel(shingleSize, signaturesCount, seed + 1);     // Independent of the first level
+
+    struct ShingledList {
+        Shingles::Signature shingle;        // Second-level
+        unsigned int list;
+    };
+
+    std::vector<Graph::const_iterator> lists;
+    std::vector<ShingledList> shingled;
+    lists.reserve(graph->listsCount());
+    shingled.reserve(graph->listsCount() * signaturesCount);
+
+    Graph::AdjacencyList shingles;      // The first-level shingles of a list, as a set
+    std::vector<Shingles::Signature> signatures(signaturesCount);
+
+    for (Graph::const_iterator it = g->begin(); it != g->end(); ++it) {
+        const Graph::Outlinks& outlinks = it->second;
+        assert(!outlinks.empty());
+
+        shingles.resize(signaturesCount);
+        firstLevel.sign(outlinks, &shingles[0]);
+        std::sort(shingles.begin(), shingles.end());
+        shingles.erase(std::unique(shingles.begin(), shingles.end()), shingles.end());
+
+        secondLevel.sign(shingles, &signatures[0]);
+        for (unsigned int k = 0; k < signaturesCount; ++k) {
+            ShingledList sl = { signatures[k], static_cast<unsigned int>(lists.size()) };
+            shingled.push_back(sl);
+        }
+        lists.push_back(it);
+    }
+
+    // The sort is stable, so the lists sharing a shingle end up together, by increasing index: all of them are
+    // joined to the first one. As for SortedBuckets, threads pay off only for big graphs
+    parallel::ThreadPool pool(lists.size() < (1 << 16) ? 1 : threadsCount);
+    parallel::radix_sort(shingled, [](const ShingledList& sl) { return sl.shingle; }, pool);
+
+    std::vector<std::size_t> parents(lists.size());
+    for (std::size_t list = 0; list < lists.size(); ++list)
+        parents[list] = list;
+
+    for (std::size_t first = 0, i = 1; i < shingled.size(); ++i) {
+        if (shingled[i].shingle != shingled[first].shingle) {
+            first = i;
+            continue;
+        }
+
+        // Union by index: the root of each component is its first list
+        std::size_t root = findRoot(parents, shingled[i].list), other = findRoot(parents, shingled[first].list);
+        if (root < other)
+            parents[other] = root;
+        else
+            parents[root] = other;
+    }
+
+    // The roots come in increasing order, so the clusters are numbered by their first list
+    std::vector<std::size_t> clusterOf(lists.size());
+    for (std::size_t list = 0; list < lists.size(); ++list) {
+        std::size_t root = findRoot(parents, list);
+        if (root == list) {
+            clusterOf[list] = clusters.size();
+            clusters.push_back(GraphCluster(graph));
+        }
+        clusters[clusterOf[root]].insert(lists[list]);
+    }
+    assert(clusters.size() <= graph->listsCount());
+
+    nextCluster = clusters.begin();
+}
+
+
+GraphCluster
+GraphPartitionerByTwoLevelShingles::getNext() {
+    if (nextCluster == clusters.end())
         return GraphCluster();      // An empty cluster indicates to the caller to have reached the end
 
-    std::map<Shingles::Signature, GraphCluster>::const_iterator currentSignature = nextSignature;
-    ++nextSignature;
+    std::vector<GraphCluster>::const_iterator currentCluster = nextCluster;
+    ++nextCluster;
 
-    assert(!currentSignature->second.empty());
-    return currentSignature->second;
+    assert(!currentCluster->empty());
+    return *currentCluster;
 }
 
 
@@ -1,10 +1,14 @@
 #ifndef SRC_GRAPH_PARTITIONER_HPP_INCLUDED
 #define SRC_GRAPH_PARTITIONER_HPP_INCLUDED
 
+#include <cstddef>      // std::size_t
+#include <iosfwd>
 #include <map>
+#include <vector>
 
 #include "Vertex.hpp"
 #include "Shingles.hpp"
+#include "utils/parallel.hpp"
 
 namespace odsg {
 
@@ -28,6 +32,17 @@ public:
 
     GraphCluster next(unsigned long minClusterArcsCount);
 
+    /*
+     * Cost-bounded alternative to next(): all the (remaining) clusters, with arcs counts in the window
+     * [minClusterArcsCount, maxClusterArcsCount] as far as possible, so the cost of mining each one is about the
+     * same. Clusters bigger than the window are split, re-hashing their lists with fresh shingles seeds, and the
+     * smaller ones are packed together by best-fit decreasing. Only a single adjacency list bigger than the window,
+     * or the lists that can't be packed up to the minimum, are left outside of it.
+     *
+     * Clusters are given by decreasing arcs count, the best order to spread them over workers.
+     */
+    std::vector<GraphCluster> pack(unsigned long minClusterArcsCount, unsigned long maxClusterArcsCount);
+
 protected:
     const Graph* const graph;
 
@@ -36,15 +51,51 @@ private:
 };
 
 
+//// SortedBuckets //////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The adjacency lists of a graph grouped in buckets by a 32-bit key, for the partitioners that group lists by a
+ * common key. The (key, list) pairs are sorted by a (parallel, for big graphs) radix sort, so each bucket is a
+ * contiguous range of a single flat array of lists; buckets come by increasing key, and the lists of each bucket
+ * keep their order in the graph.
+ */
+class SortedBuckets {
+public:
+    typedef unsigned int Key;
+
+    SortedBuckets(): lists(), bounds(1, 0), nextBucket(0) {}
+
+    /*
+     * Bucket the lists of the graph; keys[i] is the key of its i-th adjacency list. Big graphs are sorted by a pool
+     * of threadsCount threads; callers running several partitioners at once must share out their threads.
+     */
+    void build(const Graph*, const std::vector<Key>& keys,
+               unsigned int threadsCount=parallel::defaultThreadsCount());
+
+    std::size_t bucketsCount() const { return bounds.size() - 1; }
+    std::size_t bucketSize(std::size_t bucket) const { return bounds[bucket + 1] - bounds[bucket]; }   // In lists
+
+    /*
+     * The next bucket as a cluster, or an empty cluster after the last one.
+     */
+    GraphCluster next(const Graph*);
+
+private:
+    std::vector<Graph::const_iterator> lists;
+    std::vector<std::size_t> bounds;        // The i-th bucket is [bounds[i], bounds[i + 1]) of lists
+    std::size_t nextBucket;
+};
+
+
 //// GraphPartitionerByInitialOutlink /////////////////////////////////////////////////////////////////////////////////
 
 class GraphPartitionerByInitialOutlink : public GraphPartitioner {
 public:
-    GraphPartitionerByInitialOutlink(const Graph*);
+    GraphPartitionerByInitialOutlink(const Graph*,
+                                     unsigned int threadsCount=parallel::defaultThreadsCount());    // See SortedBuckets
 
 private:
-    std::map<Vertex, GraphCluster> initialOutlinks;
-    std::map<Vertex, GraphCluster>::const_iterator nextInitialOutlink;
+    SortedBuckets initialOutlinks;
 
     /*virtual*/ GraphCluster getNext();
 };
@@ -52,13 +103,65 @@ private:
 
 //// GraphPartitionerBySignature //////////////////////////////////////////////////////////////////////////////////////
 
+/*
+ * The lists are grouped by a common minhash signature. Lists sharing a hub neighbor may gather in a few huge buckets,
+ * whose dags take most of the mining time; so, with a limit of lists or arcs by bucket (0 means no limit), the lists
+ * of any bucket over it are re-signed with a fresh seed, alternating shingles of one and two outlinks, and the bucket
+ * is split by the new signature. That is repeated, level after level, until all the buckets fit or a level can't
+ * split any bucket (lists with a single outlink can't be split, by example).
+ *
+ * The signatures come from the given seed, so a partition can be reproduced; with the default seed 0, the current
+ * time is used instead.
+ */
 class GraphPartitionerBySignature : public GraphPartitioner {
 public:
-    GraphPartitionerBySignature(const Graph*);
+    explicit GraphPartitionerBySignature(const Graph*,
+                                         std::size_t maxBucketLists=0,
+                                         unsigned long maxBucketArcs=0,
+                                         unsigned long long seed=0,
+                                         unsigned int threadsCount=parallel::defaultThreadsCount());
+
+    /*
+     * Distribution of the bucket sizes, in lists, before and after re-signing the oversized buckets.
+     */
+    void printBucketsReport(std::ostream&) const;
+
+private:
+    SortedBuckets signatures;
+    std::vector<std::size_t> initialBucketsSizes;
+    unsigned int levels;        // Re-signing levels done
+
+    /*virtual*/ GraphCluster getNext();
+};
+
+
+//// GraphPartitionerByTwoLevelShingles /////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The two-pass shingling of Gibson, Kumar & Tomkins (2005): c first-level shingles are computed by adjacency list,
+ * the set of those shingles is shingled again, and the adjacency lists sharing any second-level shingle are
+ * grouped, transitively, in the same cluster (i.e. the connected components of the lists by shared second-level
+ * shingles). Lists with similar outlinks share many first-level shingles, and so likely some second-level one,
+ * while a single shared outlink is rarely enough; so the clusters are more balanced than grouping by a single
+ * signature.
+ *
+ * The lists sharing a second-level shingle are found by a radix sort of the (shingle, list) pairs, in a pool of
+ * threadsCount threads for big graphs (as for SortedBuckets), not by a lookup by shingle.
+ *
+ * The clusters are given in order of their first adjacency list in the graph, whatever the number of threads. As for
+ * GraphPartitionerBySignature, a seed 0 means a seed from the current time.
+ */
+class GraphPartitionerByTwoLevelShingles : public GraphPartitioner {
+public:
+    explicit GraphPartitionerByTwoLevelShingles(const Graph*,
+                                                unsigned int shingleSize=2,
+                                                unsigned int signaturesCount=4,
+                                                unsigned long long seed=0,
+                                                unsigned int threadsCount=parallel::defaultThreadsCount());
 
 private:
-    std::map<Shingles::Signature, GraphCluster> signatures;
-    std::map<Shingles::Signature, GraphCluster>::const_iterator nextSignature;
+    std::vector<GraphCluster> clusters;
+    std::vector<GraphCluster>::const_iterator nextCluster;
 
     /*virtual*/ GraphCluster getNext();
 };
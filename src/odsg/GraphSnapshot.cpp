@@ -0,0 +1,233 @@
+#include "GraphSnapshot.hpp"
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstring>      // std::memcmp, std::memcpy
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "Graph.hpp"
+#include "WGraph.hpp"
+#include "WedgeMap.hpp"
+
+namespace odsg {
+
+
+namespace {     // Put here general, global definitions limited to this file
+
+    const char MAGIC[8] = { 'O', 'D', 'S', 'G', 'S', 'N', 'A', 'P' };
+    const uint32_t VERSION = 1;
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    const uint32_t SORTED_BY_VERTEX_FLAG = 1;
+    const uint32_t WEIGHTED_FLAG = 2;
+
+
+    inline uint64_t
+    aligned(uint64_t size) {
+        return (size + 7) / 8 * 8;
+    }
+
+
+    template<typename T>
+    inline void
+    writeArray(std::ostream& os, const T* items, std::size_t count) {
+        os.write(reinterpret_cast<const char*>(items), static_cast<std::streamsize>(count * sizeof(T)));
+    }
+
+
+    inline void
+    writePadding(std::ostream& os, uint64_t size) {
+        static const char ZEROS[8] = { 0 };
+        os.write(ZEROS, static_cast<std::streamsize>(aligned(size) - size));
+    }
+
+}   // namespace
+
+
+//// GraphSnapshot ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct GraphSnapshot::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    uint32_t mineability;
+    uint64_t listsCount;
+    uint64_t arcsCount;
+    uint64_t weightsCount;
+};
+
+
+struct GraphSnapshot::WeightedEdge {
+    uint32_t first;
+    uint32_t second;
+    float weight;
+};
+
+
+GraphSnapshot::GraphSnapshot(const std::string& fileName)
+: file(fileName), header(NULL), vertexes(NULL), offsets(NULL), outlinks(NULL), weights(NULL) {
+
+    static_assert(sizeof(Vertex) == sizeof(uint32_t), "vertexes are written as 32-bit ids");
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(WeightedEdge) == 12, "unexpected padding in the layout");
+
+    header = reinterpret_cast<const Header*>(file.data());
+    if (file.size() < sizeof(Header) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): not a graph snapshot file");
+    }
+    if (header->byteOrder != BYTE_ORDER_MARK) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): snapshot written with another byte order");
+    }
+    if (header->version != VERSION) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): unsupported snapshot version");
+    }
+
+    // The counts are checked against the file size before computing anything from them, to avoid overflows
+    const uint64_t size = file.size();
+    if (header->listsCount > size / sizeof(Vertex) || header->arcsCount > size / sizeof(Vertex)
+        || header->weightsCount > size / sizeof(WeightedEdge) || header->mineability > 2) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): corrupted snapshot header");
+    }
+    const uint64_t vertexesAt = sizeof(Header);
+    const uint64_t offsetsAt = vertexesAt + aligned(header->listsCount * sizeof(Vertex));
+    const uint64_t outlinksAt = offsetsAt + (header->listsCount + 1) * sizeof(uint64_t);
+    const uint64_t weightsAt = outlinksAt + aligned(header->arcsCount * sizeof(Vertex));
+    if (size != weightsAt + header->weightsCount * sizeof(WeightedEdge)) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): truncated or corrupted snapshot");
+    }
+    vertexes = reinterpret_cast<const Vertex*>(file.data() + vertexesAt);
+    offsets = reinterpret_cast<const uint64_t*>(file.data() + offsetsAt);
+    outlinks = reinterpret_cast<const Vertex*>(file.data() + outlinksAt);
+    weights = reinterpret_cast<const WeightedEdge*>(file.data() + weightsAt);
+
+    // A corrupted snapshot must not give lists out of the outlinks, nor break the invariants of Graph
+    if (offsets[0] != 0 || offsets[header->listsCount] != header->arcsCount) {
+        throw std::runtime_error("GraphSnapshot::GraphSnapshot(): corrupted snapshot offsets");
+    }
+    for (uint64_t i = 0; i < header->listsCount; ++i) {
+        if (offsets[i] > offsets[i + 1] || (i > 0 && vertexes[i - 1] >= vertexes[i])) {
+            throw std::runtime_error("GraphSnapshot::GraphSnapshot(): corrupted snapshot lists");
+        }
+    }
+}
+
+
+std::size_t
+GraphSnapshot::listsCount() const {
+    return static_cast<std::size_t>(header->listsCount);
+}
+
+
+unsigned long
+GraphSnapshot::arcsCount() const {
+    return static_cast<unsigned long>(header->arcsCount);
+}
+
+
+bool
+GraphSnapshot::isWeighted() const {
+    return (header->flags & WEIGHTED_FLAG) != 0;
+}
+
+
+void
+GraphSnapshot::load(Graph& graph) const {
+    std::vector<Vertex>(outlinks, outlinks + header->arcsCount).swap(graph.outlinks);
+
+    std::vector<Graph::List>(listsCount()).swap(graph.lists);
+    const Vertex* data = graph.outlinks.data();
+    for (std::size_t i = 0; i < graph.lists.size(); ++i) {
+        graph.lists[i].first = vertexes[i];
+        graph.lists[i].second = Graph::Outlinks(data + offsets[i], data + offsets[i + 1]);
+    }
+
+    graph.sortedByVertex = (header->flags & SORTED_BY_VERTEX_FLAG) != 0;
+    graph.mineability = header->mineability;
+}
+
+
+void
+GraphSnapshot::load(WGraph& wgraph) const {
+    load(static_cast<Graph&>(wgraph));
+
+    delete wgraph.edge_map;
+    wgraph.edge_map = NULL;
+    if (!isWeighted())
+        return;
+
+    UndirectedWedgeMap* edgeMap = new UndirectedWedgeMap();
+    wgraph.edge_map = edgeMap;
+
+    // The edges come sorted as in the map, so each one is inserted at its end in constant time
+    std::map<WedgeMap::Edge, float, WedgeMap::EdgeComparer>& edges = static_cast<WedgeMap*>(edgeMap)->edge_map;
+    for (uint64_t i = 0; i < header->weightsCount; ++i) {
+        edges.insert(edges.end(), std::make_pair(WedgeMap::Edge(weights[i].first, weights[i].second),
+                                                 weights[i].weight));
+    }
+}
+
+
+void
+GraphSnapshot::write(const Graph& graph, const std::string& fileName) {
+    const WedgeMap* edgeMap = graph.get_edge_map();
+    if (edgeMap && !dynamic_cast<const UndirectedWedgeMap*>(edgeMap)) {
+        throw std::logic_error("GraphSnapshot::write(): only graphs with undirected weights are supported");
+    }
+
+    std::ofstream outfile(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outfile) {
+        throw std::runtime_error("GraphSnapshot::write(): can not open output snapshot file");
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.flags = (graph.isSortedByVertex() ? SORTED_BY_VERTEX_FLAG : 0) | (edgeMap ? WEIGHTED_FLAG : 0);
+    header.mineability = graph.mineability;
+    header.listsCount = graph.listsCount();
+    header.arcsCount = graph.arcsCount();
+    header.weightsCount = edgeMap ? edgeMap->edge_map.size() : 0;
+    writeArray(outfile, &header, 1);
+
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        writeArray(outfile, &it->first, 1);
+    }
+    writePadding(outfile, header.listsCount * sizeof(Vertex));
+
+    // The outlinks are written list after list, whatever their place in memory
+    uint64_t offset = 0;
+    writeArray(outfile, &offset, 1);
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        offset += it->second.size();
+        writeArray(outfile, &offset, 1);
+    }
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        writeArray(outfile, it->second.data(), it->second.size());
+    }
+    writePadding(outfile, header.arcsCount * sizeof(Vertex));
+
+    if (edgeMap) {
+        std::map<WedgeMap::Edge, float, WedgeMap::EdgeComparer>::const_iterator it;
+        for (it = edgeMap->edge_map.begin(); it != edgeMap->edge_map.end(); ++it) {
+            const WeightedEdge edge = { it->first.first, it->first.second, it->second };
+            writeArray(outfile, &edge, 1);
+        }
+    }
+
+    if (!outfile.flush()) {
+        throw std::runtime_error("GraphSnapshot::write(): can not write output snapshot file");
+    }
+}
+
+
+bool
+GraphSnapshot::isSnapshot(const std::string& fileName) {
+    std::ifstream infile(fileName.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return infile.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+}   // namespace odsg
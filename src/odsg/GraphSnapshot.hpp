@@ -0,0 +1,82 @@
+#ifndef SRC_GRAPH_SNAPSHOT_HPP_INCLUDED
+#define SRC_GRAPH_SNAPSHOT_HPP_INCLUDED
+
+#include <cstddef>      // std::size_t
+#include <string>
+
+#include <stdint.h>     // uint64_t
+
+#include "Vertex.hpp"
+#include "utils/io.hpp"
+
+namespace odsg {
+
+
+class Graph;
+class WGraph;
+
+/*
+ * A graph snapshot is a binary file with everything in a Graph, as it's stored in memory, so it can be loaded back
+ * without any parsing nor rebuilding: typically written once after Graph::rebuildForMining(), and opened again by
+ * each of the runs mining the same graph. The layout is, in the byte order of the writer (a snapshot from another
+ * byte order is rejected):
+ *   - A header: a magic string, the format version, the flags (sorted by vertex, weighted), the mineability and
+ *     the counts of lists, arcs and weights.
+ *   - The vertexes of the lists, by increasing id, as 32-bit ids.
+ *   - The offsets of the lists in the outlinks, one more than lists, as 64-bit integers.
+ *   - The outlinks of all the lists, list after list, as 32-bit ids.
+ *   - For graphs with undirected weights (see WGraph), the weighted edges (v1 < v2, as 32-bit ids, and a float) by
+ *     increasing (v1, v2).
+ * Each section starts at a multiple of 8 bytes from the start of the file.
+ *
+ * A GraphSnapshot object maps the file in memory during its lifetime, but loading a graph from it is a copy, not a
+ * view of the mapping in place: the arrays are copied to the graph, that owns them as any other Graph, with a pass
+ * to link the lists to their outlinks, and the weights are inserted one by one in a new edge map. What a load saves
+ * is the parsing and the rebuilding for mining, not the copy. It can throw an exception if the file isn't a valid
+ * snapshot.
+ */
+class GraphSnapshot {
+public:
+    explicit GraphSnapshot(const std::string& fileName);
+
+    std::size_t listsCount() const;
+    unsigned long arcsCount() const;
+    bool isWeighted() const;
+
+    /*
+     * Replace the contents of the graph by the snapshot. The weights, if any, are kept only by the WGraph form;
+     * a WGraph loaded from a snapshot without them is left without edge map.
+     */
+    void load(Graph&) const;
+    void load(WGraph&) const;
+
+    /*
+     * Write the graph to a snapshot file, with its weights if it's a WGraph with undirected weights.
+     */
+    static void write(const Graph&, const std::string& fileName);     // It can throw an exception
+
+    /*
+     * Whether the file starts as a snapshot, e.g. to accept both snapshots and text files as input.
+     */
+    static bool isSnapshot(const std::string& fileName);
+
+private:
+    const io::MappedFile file;
+
+    struct Header;
+    struct WeightedEdge;
+
+    const Header* header;
+    const Vertex* vertexes;
+    const uint64_t* offsets;
+    const Vertex* outlinks;
+    const WeightedEdge* weights;
+
+    // The next two are declared and deliberately NOT implemented, to prevent copying objects of this class
+    GraphSnapshot(const GraphSnapshot&);
+    GraphSnapshot& operator=(const GraphSnapshot&);
+};
+
+
+}       // namespace odsg
+#endif  // SRC_GRAPH_SNAPSHOT_HPP_INCLUDED
@@ -0,0 +1,111 @@
+#include "MultiSeedMiner.hpp"
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <algorithm>    // std::max, std::min
+#include <memory>       // std::auto_ptr
+#include <stdexcept>
+
+#include "Dag.hpp"
+#include "DagForest.hpp"
+#include "Graph.hpp"
+#include "GraphPartitioner.hpp"
+#include "utils/parallel.hpp"
+
+namespace odsg {
+
+
+MultiSeedMiner::MultiSeedMiner(const Graph& g,
+                               int clusteringScheme,
+                               unsigned int minSize,
+                               unsigned int maxSize,
+                               bool contiguous,
+                               std::size_t maxLists,
+                               unsigned long maxArcs,
+                               unsigned int shingleLength,
+                               unsigned int shinglesByList)
+: graph(g), scheme(clusteringScheme), minClusterSize(minSize), maxClusterSize(maxSize),
+  contiguousClusters(contiguous), maxBucketLists(maxLists), maxBucketArcs(maxArcs), shingleSize(shingleLength),
+  shinglesCount(shinglesByList) {
+
+    if (scheme != 2 && scheme != 3) {
+        throw std::invalid_argument("MultiSeedMiner::MultiSeedMiner(): only the hashing partitioning schemes are"
+                                    " seeded");
+    }
+    if (!graph.empty() && !graph.isMineable()) {
+        throw std::logic_error("MultiSeedMiner::MultiSeedMiner(): graph must be mineable");
+    }
+}
+
+
+DenseSubGraphsMaximalSet
+MultiSeedMiner::mine(const std::vector<unsigned long long>& seeds,
+                     unsigned int objective,
+                     bool asCliquesOnly,
+                     unsigned long minArcsCount,
+                     unsigned int threadsCount) const {
+
+    assert(threadsCount >= 1);
+
+    // Each run fills only its own slot; they are merged after all of them are done, in the order of the seeds
+    std::vector<DenseSubGraphsMaximalSet> runs(seeds.size(), DenseSubGraphsMaximalSet(asCliquesOnly));
+
+    // Fewer runs than threads leave some threads to each partitioner
+    std::size_t concurrentRuns = std::max<std::size_t>(1, std::min<std::size_t>(threadsCount, seeds.size()));
+    unsigned int partitionerThreadsCount = static_cast<unsigned int>(threadsCount / concurrentRuns);
+
+    parallel::ThreadPool pool(threadsCount);
+    pool.run(seeds.size(), [&](std::size_t run) {
+        runs[run] = mineOne(seeds[run], objective, asCliquesOnly, minArcsCount, partitionerThreadsCount);
+    });
+
+    DenseSubGraphsMaximalSet merged(asCliquesOnly);
+    for (std::vector<DenseSubGraphsMaximalSet>::const_iterator it = runs.begin(); it != runs.end(); ++it) {
+        merged.insert(*it);
+    }
+    return merged;
+}
+
+
+DenseSubGraphsMaximalSet
+MultiSeedMiner::mineOne(unsigned long long seed,
+                        unsigned int objective,
+                        bool asCliquesOnly,
+                        unsigned long minArcsCount,
+                        unsigned int partitionerThreadsCount) const {
+
+    assert(seed != 0);
+
+    DenseSubGraphsMaximalSet dsgs(asCliquesOnly);
+    if (graph.empty())
+        return dsgs;
+
+    std::auto_ptr<GraphPartitioner> partitioner;
+    if (scheme == 2)
+        partitioner.reset(new GraphPartitionerBySignature(&graph, maxBucketLists, maxBucketArcs, seed,
+                                                          partitionerThreadsCount));
+    else
+        partitioner.reset(new GraphPartitionerByTwoLevelShingles(&graph, shingleSize, shinglesCount, seed,
+                                                                 partitionerThreadsCount));
+
+    DagForest::stream(graph, *partitioner, [&](const Dag& dag) {
+        dsgs.insert(dag.getDenseSubGraphs(0, objective, asCliquesOnly, minArcsCount));
+    }, minClusterSize, false, maxClusterSize, contiguousClusters, partitionerThreadsCount);
+
+    return dsgs;
+}
+
+
+std::vector<unsigned long long>
+MultiSeedMiner::seeds(unsigned long long seed, unsigned int runsCount) {
+    static const unsigned long long GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;     // As the increment of SplitMix64
+
+    std::vector<unsigned long long> runSeeds;
+    for (unsigned int run = 0; run < runsCount; ++run) {
+        seed += GOLDEN_GAMMA;
+        runSeeds.push_back(seed != 0 ? seed : GOLDEN_GAMMA);
+    }
+    return runSeeds;
+}
+
+
+}   // namespace odsg
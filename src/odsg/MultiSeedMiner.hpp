@@ -0,0 +1,75 @@
+#ifndef SRC_MULTI_SEED_MINER_HPP_INCLUDED
+#define SRC_MULTI_SEED_MINER_HPP_INCLUDED
+
+#include <cstddef>      // std::size_t
+#include <vector>
+
+#include "DenseSubGraphsMaximalSet.hpp"
+
+namespace odsg {
+
+
+class Graph;
+
+/*
+ * The hashing partitioning schemes decide by their seed which adjacency lists meet in a dag, so a dense subgraph
+ * whose lists fall in different clusters is lost in a single run. A MultiSeedMiner repeats the partitioning, the
+ * building of the dags and their mining with several independent seeds, and merges everything mined in a single
+ * maximal set.
+ *
+ * The graph is rebuilt for mining once, by the caller, and shared read-only by all the runs; only the partitions
+ * and the dags are built by run. The runs are spread over a pool of threads, and merged in the order of their seeds,
+ * so the result depends on the seeds but not on the number of threads. The threads left over by the runs, if any,
+ * are shared out among the partitioners, so the runs never take more than the given number of threads.
+ *
+ * The lifetime of the graph must extend past any use of the respective MultiSeedMiner object.
+ */
+class MultiSeedMiner {
+public:
+    MultiSeedMiner(const Graph&,
+                   int clusteringScheme,                // Only the hashing ones, 2 or 3 as in DagForest
+                   unsigned int minClusterSize=1,
+                   unsigned int maxClusterSize=0,
+                   bool contiguousClusters=false,       // See DagForest
+                   std::size_t maxBucketLists=0,        // See GraphPartitionerBySignature, for the scheme 2
+                   unsigned long maxBucketArcs=0,
+                   unsigned int shingleSize=2,          // See GraphPartitionerByTwoLevelShingles, for the scheme 3
+                   unsigned int shinglesCount=4);       // It can throw an exception
+
+    /*
+     * The arguments of the mining are those of Dag::getDenseSubGraphs(). Seeds must not be 0, which stands for a
+     * seed from the current time in the partitioners.
+     */
+    DenseSubGraphsMaximalSet mine(const std::vector<unsigned long long>& seeds,
+                                  unsigned int objective,
+                                  bool asCliquesOnly,
+                                  unsigned long minArcsCount,
+                                  unsigned int threadsCount=1) const;
+
+    /*
+     * runsCount reproducible seeds derived from a single one, spaced so that the seeds used inside a partitioner
+     * (seed + 1, seed + 2...) don't collide with the ones of other runs.
+     */
+    static std::vector<unsigned long long> seeds(unsigned long long seed, unsigned int runsCount);
+
+private:
+    const Graph& graph;
+    int scheme;
+    unsigned int minClusterSize;
+    unsigned int maxClusterSize;
+    bool contiguousClusters;
+    std::size_t maxBucketLists;
+    unsigned long maxBucketArcs;
+    unsigned int shingleSize;
+    unsigned int shinglesCount;
+
+    DenseSubGraphsMaximalSet mineOne(unsigned long long seed,
+                                     unsigned int objective,
+                                     bool asCliquesOnly,
+                                     unsigned long minArcsCount,
+                                     unsigned int partitionerThreadsCount) const;
+};
+
+
+}       // namespace odsg
+#endif  // SRC_MULTI_SEED_MINER_HPP_INCLUDED
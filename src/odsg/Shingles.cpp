@@ -2,43 +2,101 @@
 
 #include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
 #include <cstddef>      // NULL, std::size_t
-#include <string>
-#include <cstdlib>      // std::rand, std::srand
 #include <ctime>        // std::time
 
-#include <boost/functional/hash.hpp>
-
 #include "utils/algorithms.hpp"
-#include "utils/strings.hpp"
 
 namespace odsg {
 
 
-Shingles::Shingles() {
-    std::srand(std::time(NULL));
-    A = (std::rand() % bigPrime) + 1;
-    B = (std::rand() % bigPrime) + 1;
+namespace {     // Put here general, global definitions limited to this file
+
+    /*
+     * SplitMix64 step, used to expand a seed into the coefficients of the hash functions.
+     */
+    unsigned long long
+    splitmix64(unsigned long long& state) {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+     * 64-bit hash of the shingle [first, last), shared by all the signatures.
+     */
+    unsigned long long
+    shingleHash(const Vertex* first, const Vertex* last) {
+        unsigned long long h = 0xCBF29CE484222325ULL;
+        for ( ; first != last; ++first) {
+            h = (h ^ *first) * 0x100000001B3ULL;
+            h ^= h >> 29;
+        }
+        return h;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Shingles::Shingles(unsigned int shingleSize, unsigned int signaturesCount): size(shingleSize), A(), B() {
+    init(static_cast<unsigned long long>(std::time(NULL)), signaturesCount);
+}
+
+
+Shingles::Shingles(unsigned int shingleSize, unsigned int signaturesCount, unsigned long long seed)
+: size(shingleSize), A(), B() {
+    init(seed, signaturesCount);
+}
+
+
+void
+Shingles::init(unsigned long long seed, unsigned int signaturesCount) {
+    assert(size >= 1);
+    assert(signaturesCount >= 1);
+
+    for (unsigned int k = 0; k < signaturesCount; ++k) {
+        A.push_back(splitmix64(seed) | 1);
+        B.push_back(splitmix64(seed));
+    }
+}
+
+
+void
+Shingles::sign(const Graph::Outlinks& outlinks, Signature* out) const {
+    sign(outlinks, out, signaturesCount());
 }
 
 
 Shingles::Signature
-Shingles::sign(const Graph::AdjacencyList& outlinks) const {
+Shingles::sign(const Graph::Outlinks& outlinks) const {
+    Signature signature;
+    sign(outlinks, &signature, 1);
+    return signature;
+}
+
+
+void
+Shingles::sign(const Graph::Outlinks& outlinks, Signature* out, unsigned int count) const {
     assert(!outlinks.empty());
-    assert(algorithms::has_unique(outlinks));
+    assert(algorithms::has_unique(Graph::AdjacencyList(outlinks.begin(), outlinks.end())));
+    assert(count <= signaturesCount());
+
+    const Vertex* first = outlinks.data();
+    std::size_t window = outlinks.size() < size ? outlinks.size() : size;
+    std::size_t shingles = outlinks.size() - window + 1;
 
-    boost::hash<std::string> stringHash;
-    Signature minShingleHash = bigPrime;
+    for (unsigned int k = 0; k < count; ++k)
+        out[k] = ~Signature(0);
 
-    for (Graph::AdjacencyList::const_iterator vxit = outlinks.begin(); vxit != outlinks.end(); ++vxit) {
-        std::size_t shingleID = stringHash(strings::to_str(*vxit));
+    for (std::size_t i = 0; i < shingles; ++i) {
+        unsigned long long h = shingleHash(first + i, first + i + window);
 
-        // TODO: I need to reexamine these calculations; these aren't completely OK
-        Signature shingleHash = (((unsigned long) A * (unsigned long) shingleID) + B) % bigPrime;
-        if (minShingleHash > shingleHash) {
-            minShingleHash = shingleHash;
+        for (unsigned int k = 0; k < count; ++k) {
+            Signature hash = static_cast<Signature>((A[k] * h + B[k]) >> 32);
+            if (out[k] > hash)
+                out[k] = hash;
         }
     }
-    return minShingleHash;
 }
 
 
@@ -1,6 +1,8 @@
 #ifndef SRC_SHINGLES_HPP_INCLUDED
 #define SRC_SHINGLES_HPP_INCLUDED
 
+#include <vector>
+
 #include "Graph.hpp"
 
 namespace odsg {
@@ -8,22 +10,46 @@ namespace odsg {
 
 /*
  * Shingles are expected to be required only from the GraphPartitionerBySignature class.
- * The current implementation is most basic possible, supporting shingles, as defined in the literature, of size = 1
- * and a unique signature.
+ *
+ * A shingle, as defined in the literature, is a group of s consecutive outlinks of an adjacency list; lists shorter
+ * than s make a single shingle with all their outlinks. Each one of the c signatures of a list is the minimum hash
+ * of its shingles by a different function of a family of seeded 'multiply-shift' hash functions. The vertex ids are
+ * hashed directly as integers, and the signatures are written in a buffer given by the caller, so signing a list
+ * doesn't allocate anything.
+ *
+ * The signatures depend only on the seed, the shingle size and the signatures count; without an explicit seed, a
+ * different one is taken in each run.
  */
 class Shingles {
 public:
     typedef unsigned int Signature;
 
-    Shingles();
+    explicit Shingles(unsigned int shingleSize=1, unsigned int signaturesCount=1);
+    Shingles(unsigned int shingleSize, unsigned int signaturesCount, unsigned long long seed);
+
+    unsigned int shingleSize() const { return size; }
+    unsigned int signaturesCount() const { return static_cast<unsigned int>(A.size()); }
+
+    /*
+     * Write signaturesCount() signatures of the (non empty) adjacency list in out.
+     */
+    void sign(const Graph::Outlinks&, Signature* out) const;
 
-    Signature sign(const Graph::AdjacencyList&) const;
+    /*
+     * The first signature of the adjacency list.
+     */
+    Signature sign(const Graph::Outlinks&) const;
 
 private:
-    static const unsigned long bigPrime = 0x7FFFFFFF;   // Same as 2^31 - 1, that is prime
+    unsigned int size;
+
+    std::vector<unsigned long long> A;      // A, as in (A x + B) >> 32, with odd A
+    std::vector<unsigned long long> B;
+
+    void init(unsigned long long seed, unsigned int signaturesCount);
 
-    unsigned int A;     // A, as in a X + b mod bigPrime
-    unsigned int B;     // B, as in a X + b mod bigPrime
+    // The first count signatures of the adjacency list, written in out; both public overloads share it
+    void sign(const Graph::Outlinks&, Signature* out, unsigned int count) const;
 };
 
 
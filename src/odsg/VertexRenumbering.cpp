@@ -0,0 +1,309 @@
+#include "VertexRenumbering.hpp"
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <algorithm>    // std::sort, std::unique, std::lower_bound
+#include <map>
+#include <stdexcept>
+
+#include "DenseSubGraph.hpp"
+#include "Graph.hpp"
+#include "WGraph.hpp"
+#include "WedgeMap.hpp"
+
+namespace odsg {
+
+
+namespace {     // Put here general, global definitions limited to this file
+
+    /*
+     * The vertexes of a graph as the dense indexes of their sorted ids, with their (undirected, without self-loops)
+     * neighbors in CSR form, and their number of apparitions in the adjacency lists.
+     */
+    struct IndexedGraph {
+        std::vector<Vertex> ids;                // By index, increasing
+        std::vector<std::size_t> offsets;       // The neighbors of i are [offsets[i], offsets[i + 1]) of neighbors
+        std::vector<std::size_t> neighbors;
+        std::vector<unsigned int> frequencies;
+
+        explicit IndexedGraph(const Graph&);
+
+        std::size_t size() const { return ids.size(); }
+        std::size_t indexOf(Vertex vx) const { return std::lower_bound(ids.begin(), ids.end(), vx) - ids.begin(); }
+        std::size_t degree(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+    };
+
+
+    IndexedGraph::IndexedGraph(const Graph& graph): ids(), offsets(), neighbors(), frequencies() {
+        for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+            ids.push_back(it->first);
+            ids.insert(ids.end(), it->second.begin(), it->second.end());
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        // Both directions of each arc, as pairs (from, to), then grouped by a counting sort on from
+        std::vector<std::size_t> froms, tos;
+        frequencies.assign(size(), 0);
+        for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+            std::size_t from = indexOf(it->first);
+            for (Graph::Outlinks::const_iterator vxit = it->second.begin(); vxit != it->second.end(); ++vxit) {
+                std::size_t to = indexOf(*vxit);
+                frequencies[to]++;
+                if (to == from)
+                    continue;
+                froms.push_back(from);
+                tos.push_back(to);
+                froms.push_back(to);
+                tos.push_back(from);
+            }
+        }
+
+        offsets.assign(size() + 1, 0);
+        for (std::size_t a = 0; a < froms.size(); ++a)
+            offsets[froms[a] + 1]++;
+        for (std::size_t i = 0; i < size(); ++i)
+            offsets[i + 1] += offsets[i];
+
+        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+        std::vector<std::size_t> all(froms.size());
+        for (std::size_t a = 0; a < froms.size(); ++a)
+            all[next[froms[a]]++] = tos[a];
+
+        // Sorted and without duplicates (arcs given in both directions by the input)
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < size(); ++i) {
+            std::vector<std::size_t>::iterator first = all.begin() + offsets[i], last = all.begin() + offsets[i + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+
+            offsets[i] = kept;
+            for ( ; first != last; ++first)
+                all[kept++] = *first;
+        }
+        offsets[size()] = kept;
+        all.resize(kept);
+        neighbors.swap(all);
+    }
+
+
+    std::vector<std::size_t>
+    degreeOrder(const IndexedGraph& graph) {
+        std::vector<std::size_t> order(graph.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        std::stable_sort(order.begin(), order.end(), [&graph](std::size_t a, std::size_t b) {
+            return graph.frequencies[a] > graph.frequencies[b];
+        });
+        return order;
+    }
+
+
+    std::vector<std::size_t>
+    cuthillMcKeeOrder(const IndexedGraph& graph) {
+        // Vertexes by increasing degree: the starts of the searches, and the order to visit the neighbors
+        std::vector<std::size_t> byDegree(graph.size());
+        std::vector<std::size_t> rank(graph.size());
+        for (std::size_t i = 0; i < byDegree.size(); ++i)
+            byDegree[i] = i;
+        std::stable_sort(byDegree.begin(), byDegree.end(), [&graph](std::size_t a, std::size_t b) {
+            return graph.degree(a) < graph.degree(b);
+        });
+        for (std::size_t r = 0; r < byDegree.size(); ++r)
+            rank[byDegree[r]] = r;
+
+        std::vector<std::size_t> order;
+        order.reserve(graph.size());
+        std::vector<bool> visited(graph.size(), false);
+        std::vector<std::size_t> found;
+
+        for (std::vector<std::size_t>::const_iterator start = byDegree.begin(); start != byDegree.end(); ++start) {
+            if (visited[*start])
+                continue;
+
+            visited[*start] = true;
+            order.push_back(*start);
+            for (std::size_t head = order.size() - 1; head < order.size(); ++head) {    // order is the queue too
+                std::size_t i = order[head];
+
+                found.clear();
+                for (std::size_t n = graph.offsets[i]; n < graph.offsets[i + 1]; ++n) {
+                    if (!visited[graph.neighbors[n]]) {
+                        visited[graph.neighbors[n]] = true;
+                        found.push_back(graph.neighbors[n]);
+                    }
+                }
+                std::sort(found.begin(), found.end(), [&rank](std::size_t a, std::size_t b) {
+                    return rank[a] < rank[b];
+                });
+                order.insert(order.end(), found.begin(), found.end());
+            }
+        }
+
+        assert(order.size() == graph.size());
+        return order;
+    }
+
+
+    std::vector<std::size_t>
+    communityOrder(const IndexedGraph& graph) {
+        static const unsigned int MAX_ROUNDS = 20;
+
+        // Label propagation: each vertex takes the most frequent label between its neighbors (the smallest one on
+        // ties), sweeping the vertexes in order until nothing changes
+        std::vector<std::size_t> labels(graph.size());
+        for (std::size_t i = 0; i < labels.size(); ++i)
+            labels[i] = i;
+
+        std::vector<std::size_t> counts(graph.size(), 0);
+        std::vector<std::size_t> seen;
+        for (unsigned int round = 0; round < MAX_ROUNDS; ++round) {
+            bool changed = false;
+
+            for (std::size_t i = 0; i < graph.size(); ++i) {
+                if (graph.degree(i) == 0)
+                    continue;
+
+                seen.clear();
+                for (std::size_t n = graph.offsets[i]; n < graph.offsets[i + 1]; ++n) {
+                    std::size_t label = labels[graph.neighbors[n]];
+                    if (counts[label]++ == 0)
+                        seen.push_back(label);
+                }
+
+                std::size_t best = labels[i], bestCount = 0;
+                for (std::vector<std::size_t>::const_iterator it = seen.begin(); it != seen.end(); ++it) {
+                    if (counts[*it] > bestCount || (counts[*it] == bestCount && *it < best)) {
+                        best = *it;
+                        bestCount = counts[*it];
+                    }
+                    counts[*it] = 0;
+                }
+
+                if (best != labels[i]) {
+                    labels[i] = best;
+                    changed = true;
+                }
+            }
+            if (!changed)
+                break;
+        }
+
+        std::vector<std::size_t> sizes(graph.size(), 0);
+        for (std::size_t i = 0; i < labels.size(); ++i)
+            sizes[labels[i]]++;
+
+        std::vector<std::size_t> order = degreeOrder(graph);
+        std::stable_sort(order.begin(), order.end(), [&labels, &sizes](std::size_t a, std::size_t b) {
+            if (sizes[labels[a]] != sizes[labels[b]])
+                return sizes[labels[a]] > sizes[labels[b]];
+            return labels[a] < labels[b];
+        });
+        return order;
+    }
+}
+
+
+VertexRenumbering::VertexRenumbering(const Graph& graph, Order order): originals(), renumbered() {
+    const IndexedGraph indexed(graph);
+
+    std::vector<std::size_t> permutation;
+    switch (order) {
+        case DEGREE:            permutation = degreeOrder(indexed);
+                                break;
+        case CUTHILL_MCKEE:     permutation = cuthillMcKeeOrder(indexed);
+                                break;
+        case COMMUNITY:         permutation = communityOrder(indexed);
+                                break;
+    }
+    assert(permutation.size() == indexed.size());
+
+    originals.reserve(permutation.size());
+    renumbered.reserve(permutation.size());
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+        originals.push_back(indexed.ids[permutation[i]]);
+        renumbered[indexed.ids[permutation[i]]] = static_cast<Vertex>(i);
+    }
+}
+
+
+Vertex
+VertexRenumbering::operator()(Vertex original) const {
+    return renumbered.at(original);     // Throws for vertexes outside of the graph
+}
+
+
+VertexSet
+VertexRenumbering::original(const VertexSet& vxset) const {
+    VertexSet originalSet;
+    for (VertexSet::const_iterator vxit = vxset.begin(); vxit != vxset.end(); ++vxit) {
+        originalSet.insert(original(*vxit));
+    }
+    return originalSet;
+}
+
+
+DenseSubGraph
+VertexRenumbering::original(const DenseSubGraph& dsg) const {
+    DenseSubGraph originalDsg(original(dsg.getSources()), original(dsg.getCenters()));
+    originalDsg.set_density_value(dsg.get_density_value());
+    return originalDsg;
+}
+
+
+Graph
+VertexRenumbering::apply(const Graph& graph) const {
+    std::map<Vertex, Graph::AdjacencyList> lists;
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        Graph::AdjacencyList& outlinks = lists[(*this)(it->first)];
+        outlinks.reserve(it->second.size());
+        for (Graph::Outlinks::const_iterator vxit = it->second.begin(); vxit != it->second.end(); ++vxit) {
+            outlinks.push_back((*this)(*vxit));
+        }
+    }
+    return Graph(lists);
+}
+
+
+WGraph
+VertexRenumbering::apply(const WGraph& wgraph) const {
+    const UndirectedWedgeMap* edgeMap = dynamic_cast<const UndirectedWedgeMap*>(wgraph.get_edge_map());
+    if (!edgeMap) {
+        throw std::logic_error("VertexRenumbering::apply(): only graphs with undirected weights are supported");
+    }
+
+    std::map<Vertex, VertexSet> lists;
+    for (Graph::const_iterator it = wgraph.begin(); it != wgraph.end(); ++it) {
+        VertexSet& outlinks = lists[(*this)(it->first)];
+        for (Graph::Outlinks::const_iterator vxit = it->second.begin(); vxit != it->second.end(); ++vxit) {
+            outlinks.insert((*this)(*vxit));
+        }
+    }
+    return WGraph(lists, edgeMap->renumbered([this](Vertex vx) { return (*this)(vx); }));
+}
+
+
+std::string
+VertexRenumbering::toString(Order order) {
+    switch (order) {
+        case DEGREE:            return "DEGREE";
+        case CUTHILL_MCKEE:     return "CUTHILL_MCKEE";
+        case COMMUNITY:         return "COMMUNITY";
+    }
+    return "";
+}
+
+
+VertexRenumbering::Order
+VertexRenumbering::toOrder(const std::string& name) {
+    if (name == "DEGREE")
+        return DEGREE;
+    if (name == "CUTHILL_MCKEE")
+        return CUTHILL_MCKEE;
+    if (name == "COMMUNITY")
+        return COMMUNITY;
+    throw std::invalid_argument("VertexRenumbering::toOrder(): unknown order " + name);
+}
+
+
+}   // namespace odsg
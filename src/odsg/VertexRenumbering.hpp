@@ -0,0 +1,71 @@
+#ifndef SRC_VERTEX_RENUMBERING_HPP_INCLUDED
+#define SRC_VERTEX_RENUMBERING_HPP_INCLUDED
+
+#include <cstddef>      // std::size_t
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Vertex.hpp"
+#include "VertexSet.hpp"
+
+namespace odsg {
+
+
+class DenseSubGraph;
+class Graph;
+class WGraph;
+
+/*
+ * A VertexRenumbering object is a permutation of the vertexes of a graph into the dense ids 0, 1, ... n-1, chosen to
+ * give locality to the adjacency lists: vertexes that appear together get close ids, so the lookups keyed by
+ * vertex (the nodes map in Dag::insert(), WedgeMap, the comparers) touch nearby memory, and the renumbered graph
+ * sorted by id (Graph::VertexComparer) follows that order. The orders available are:
+ *   - DEGREE: by decreasing number of apparitions in the adjacency lists, as Graph::VertexFrequencyComparer.
+ *   - CUTHILL_MCKEE: breadth-first search from a vertex of minimum degree, visiting the neighbors by increasing
+ *     degree, and so on for each connected component ('Cuthill-McKee' ordering); it keeps the ids of neighbors
+ *     close.
+ *   - COMMUNITY: the communities found by label propagation, one after another by decreasing size, and by
+ *     decreasing degree inside each one.
+ * All the orders are deterministic: ties are broken by the original ids.
+ *
+ * The inverse permutation is kept, so anything mined from the renumbered graph can be reported in original ids.
+ */
+class VertexRenumbering {
+public:
+    enum Order { DEGREE, CUTHILL_MCKEE, COMMUNITY };
+
+    VertexRenumbering(const Graph&, Order);
+
+    std::size_t size() const { return originals.size(); }
+
+    /*
+     * The new id of a vertex of the graph, and the original id of a new one.
+     */
+    Vertex operator()(Vertex original) const;
+    Vertex original(Vertex renumbered) const { return originals[renumbered]; }
+
+    VertexSet original(const VertexSet&) const;
+    DenseSubGraph original(const DenseSubGraph&) const;
+
+    /*
+     * A copy of the graph (with the weights of its edges, for WGraph) with all the vertexes renumbered. The
+     * copy must be rebuilt for mining anew.
+     */
+    Graph apply(const Graph&) const;
+    WGraph apply(const WGraph&) const;      // It can throw an exception
+
+    /*
+     * The name of an order, and back, e.g. for command line options. toOrder() can throw an exception.
+     */
+    static std::string toString(Order);
+    static Order toOrder(const std::string&);
+
+private:
+    std::vector<Vertex> originals;                      // By new id
+    std::unordered_map<Vertex, Vertex> renumbered;      // By original id
+};
+
+
+}       // namespace odsg
+#endif  // SRC_VERTEX_RENUMBERING_HPP_INCLUDED
@@ -8,6 +8,7 @@ namespace odsg {
 
 void
 WGraph::clone_edge_map_ptr( const WedgeMap *ptr ) {
+   edge_map = 0;
    if( !ptr ) return;
    switch( ptr->get_type() ) {
       case UNDIRECTED_WITH_SYMETRIC_WEIGHT:
@@ -46,8 +47,11 @@ WGraph::~WGraph(){ delete edge_map; }
 
 WGraph&
 WGraph::operator = (const WGraph& WG) {
+   if( this == &WG ) return *this;
    static_cast<Graph&>(*this) = WG;
+   WedgeMap* old_edge_map = edge_map;   // Freed only after cloning, in case that it throws
    clone_edge_map_ptr( WG.edge_map );
+   delete old_edge_map;
    return *this;
 }
 
@@ -33,6 +33,8 @@ public:
 
 private:
 
+   friend class GraphSnapshot;
+
    WedgeMap* edge_map;
    void clone_edge_map_ptr( const WedgeMap *ptr );
 };
@@ -34,6 +34,8 @@ public:
    
 protected:
 
+   friend class GraphSnapshot;   // Reads and writes the edges in bulk
+
    struct Edge {
       const Vertex  first;
       const Vertex second;
@@ -74,6 +76,18 @@ public:
    void    add_edge( Vertex v1, Vertex v2, float value );
    float get_weight( Vertex v1, Vertex v2 )        const;
 
+   /*
+    * Copy of the map with each vertex v replaced by renumber(v), e.g. a VertexRenumbering.
+    */
+   template<typename Renumber>
+   UndirectedWedgeMap renumbered( Renumber renumber ) const {
+      UndirectedWedgeMap copy;
+      std::map<Edge, float, EdgeComparer>::const_iterator it;
+      for( it = edge_map.begin(); it != edge_map.end(); ++it )
+         copy.add_edge( renumber(it->first.first), renumber(it->first.second), it->second );
+      return copy;
+   }
+
 private:
 
    float weight_sum(const VertexSet& centers, const VertexSet& sources,
@@ -0,0 +1,188 @@
+#ifndef SRC_UTILS_IO_HPP_INCLUDED
+#define SRC_UTILS_IO_HPP_INCLUDED
+
+#include <cstddef>      // std::size_t
+#include <cstdlib>      // std::strtod
+#include <cstring>      // std::memchr, std::memcpy
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, munmap, madvise
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+
+namespace odsg {
+
+
+/*
+ * Fast input of big text files: the files are mapped in memory instead of read, and the numbers are parsed in
+ * place, without building a string by line or by token.
+ */
+namespace io {
+
+
+/*
+ * A MappedFile object maps a whole file, read-only, during its lifetime. The contents are accessed as a plain
+ * array of chars, [data(), data() + size()); there is no '\0' at the end.
+ *
+ * It can throw an exception
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName);
+    ~MappedFile();
+
+    const char* data() const { return contents; }
+    std::size_t size() const { return length; }
+
+private:
+    const char* contents;
+    std::size_t length;
+
+    // The next two are declared and deliberately NOT implemented, to prevent copying objects of this class
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+
+inline
+MappedFile::MappedFile(const std::string& fileName): contents(NULL), length(0) {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("MappedFile: can not open " + fileName);
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: can not stat " + fileName);
+    }
+
+    length = static_cast<std::size_t>(status.st_size);
+    if (length > 0) {       // Empty files can't be mapped, but there is nothing to read from them anyway
+        void* address = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: can not map " + fileName);
+        }
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        contents = static_cast<const char*>(address);
+    }
+    ::close(fd);        // The mapping keeps its own reference to the file
+}
+
+
+inline
+MappedFile::~MappedFile() {
+    if (contents)
+        ::munmap(const_cast<char*>(contents), length);
+}
+
+
+/*
+ * End of the line starting at first: the position of its '\n', or last if it's the final line without one.
+ */
+inline const char*
+end_of_line(const char* first, const char* last) {
+    const char* eol = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    return eol ? eol : last;
+}
+
+
+/*
+ * Split [data, data + size) in about 'parts' ranges of similar length, each one made of whole lines; returns the
+ * parts + 1 boundaries. Some ranges can be empty when the lines are long.
+ */
+inline std::vector<std::size_t>
+line_aligned_bounds(const char* data, std::size_t size, std::size_t parts) {
+    std::vector<std::size_t> bounds;
+    for (std::size_t i = 0; i <= parts; ++i)
+        bounds.push_back(size / parts * i + (i < size % parts ? i : size % parts));
+
+    for (std::size_t i = 1; i + 1 < bounds.size(); ++i) {
+        std::size_t from = bounds[i] > bounds[i - 1] ? bounds[i] : bounds[i - 1];
+        bounds[i] = (from == 0) ? 0 : end_of_line(data + from - 1, data + size) - data + 1;
+        if (bounds[i] > size)
+            bounds[i] = size;
+    }
+    return bounds;
+}
+
+
+/*
+ * Parse the next integer of [first, last), advancing first past it. Leading whitespaces are skipped.
+ * Returns false, with first pointing to the offending char, if there is no valid integer there (end of the range,
+ * something that isn't a number, or an overflow); so a loop over a line stops exactly where
+ *   std::istringstream(line) >> value
+ * would stop.
+ */
+inline bool
+parse_integer(const char*& first, const char* last, long long int& value) {
+    const char* p = first;
+    while (p < last && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f' || *p == '\n'))
+        ++p;
+    first = p;
+
+    bool negative = false;
+    if (p < last && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p == last || static_cast<unsigned char>(*p - '0') > 9)
+        return false;
+
+    const unsigned long long limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+    unsigned long long magnitude = 0;
+    for ( ; p < last && static_cast<unsigned char>(*p - '0') <= 9; ++p) {
+        unsigned int digit = static_cast<unsigned int>(*p - '0');
+        if (magnitude > (limit - digit) / 10)
+            return false;
+        magnitude = magnitude * 10 + digit;
+    }
+
+    value = negative ? static_cast<long long int>(0ULL - magnitude) : static_cast<long long int>(magnitude);
+    first = p;
+    return true;
+}
+
+
+/*
+ * Parse the next real number of [first, last), advancing first past it. Leading whitespaces are skipped.
+ * Returns false, with first pointing to the offending char, if there is no valid number there. Unlike
+ * parse_integer, the whole token (up to the next whitespace) must be a number.
+ */
+inline bool
+parse_real(const char*& first, const char* last, double& value) {
+    const char* p = first;
+    while (p < last && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f' || *p == '\n'))
+        ++p;
+    first = p;
+
+    const char* end = p;
+    while (end < last && !(*end == ' ' || *end == '\t' || *end == '\r' || *end == '\v' || *end == '\f'
+                           || *end == '\n'))
+        ++end;
+
+    // std::strtod needs a '\0' at the end, that the mapped files haven't
+    char token[64];
+    std::size_t length = static_cast<std::size_t>(end - p);
+    if (length == 0 || length >= sizeof(token))
+        return false;
+    std::memcpy(token, p, length);
+    token[length] = '\0';
+
+    char* parsed;
+    double number = std::strtod(token, &parsed);
+    if (parsed != token + length)
+        return false;
+
+    value = number;
+    first = end;
+    return true;
+}
+
+
+}       // namespace io
+}       // namespace odsg
+#endif  // SRC_UTILS_IO_HPP_INCLUDED
@@ -0,0 +1,250 @@
+#ifndef SRC_UTILS_PARALLEL_HPP_INCLUDED
+#define SRC_UTILS_PARALLEL_HPP_INCLUDED
+
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cstddef>      // std::size_t
+#include <vector>
+#include <algorithm>    // std::min
+#include <atomic>
+#include <condition_variable>
+#include <exception>    // std::exception_ptr
+#include <functional>   // std::function
+#include <mutex>
+#include <thread>
+
+namespace odsg {
+
+
+/*
+ * Minimal support for data parallelism: a fixed pool of threads running batches of independent, indexed tasks.
+ * It's all we need for the embarrassingly parallel stages of the pipeline (signing, parsing, sorting by chunks).
+ */
+namespace parallel {
+
+
+/*
+ * Number of threads to use when the user doesn't choose it: one by hardware thread, if known.
+ */
+inline unsigned int
+defaultThreadsCount() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count ? count : 1;
+}
+
+
+/*
+ * A ThreadPool object keeps threadsCount - 1 worker threads alive during its lifetime; the thread calling run()
+ * works too, so a pool of size 1 runs everything in the calling thread, without any synchronization.
+ *
+ * run(n, task) calls task(i) for each i in [0, n), in any order and from any thread of the pool, and returns when
+ * all of them are done. Determinism is therefore a duty of the caller: the usual way is to make each task write
+ * only its own slot of a pre-sized output, and to combine the slots by index after run() returns.
+ * If some task throws, the first exception caught is rethrown by run() once the batch is over.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadsCount=defaultThreadsCount());
+    ~ThreadPool();
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    template<typename Task>
+    void run(std::size_t tasksCount, Task task);
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable batchReady;
+    std::condition_variable batchDone;
+
+    std::function<void(std::size_t)> currentTask;
+    std::size_t tasksCount;
+    std::atomic<std::size_t> nextTask;
+    unsigned int busyWorkers;
+    unsigned long batch;            // Incremented with each call to run(), to wake up the workers
+    bool stopping;
+    std::exception_ptr firstError;
+
+    void workerLoop();
+    void runTasks();
+
+    // The next two are declared and deliberately NOT implemented, to prevent copying objects of this class
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+
+inline
+ThreadPool::ThreadPool(unsigned int threadsCount)
+: workers(), currentTask(), tasksCount(0), nextTask(0), busyWorkers(0), batch(0), stopping(false), firstError() {
+
+    assert(threadsCount >= 1);
+
+    for (unsigned int i = 1; i < threadsCount; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+
+inline
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    batchReady.notify_all();
+
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+}
+
+
+template<typename Task>
+inline void
+ThreadPool::run(std::size_t count, Task task) {
+    if (count == 0)
+        return;
+
+    if (workers.empty() || count == 1) {    // Nothing to share
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = task;
+        tasksCount = count;
+        nextTask = 0;
+        busyWorkers = static_cast<unsigned int>(workers.size());
+        firstError = std::exception_ptr();
+        ++batch;
+    }
+    batchReady.notify_all();
+
+    runTasks();     // The calling thread works too
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (busyWorkers > 0)
+            batchDone.wait(lock);
+
+        currentTask = std::function<void(std::size_t)>();
+        error = firstError;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+
+inline void
+ThreadPool::workerLoop() {
+    unsigned long seenBatch = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && batch == seenBatch)
+                batchReady.wait(lock);
+
+            if (stopping)
+                return;
+            seenBatch = batch;
+        }
+
+        runTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        batchDone.notify_one();
+    }
+}
+
+
+inline void
+ThreadPool::runTasks() {
+    for (std::size_t i = nextTask++; i < tasksCount; i = nextTask++) {
+        try {
+            currentTask(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!firstError)
+                firstError = std::current_exception();
+        }
+    }
+}
+
+
+/*
+ * Split [0, size) in about 'parts' contiguous ranges of similar length; returns the parts + 1 boundaries.
+ */
+inline std::vector<std::size_t>
+split_evenly(std::size_t size, std::size_t parts) {
+    assert(parts >= 1);
+
+    std::vector<std::size_t> bounds;
+    for (std::size_t i = 0; i <= parts; ++i) {
+        bounds.push_back(size / parts * i + std::min(i, size % parts));
+    }
+    return bounds;
+}
+
+
+/*
+ * Stable sort of items by an unsigned 32-bit key, keyOf(item), by a LSD radix sort of 4 passes of 8 bits. Each pass
+ * counts the digits of consecutive chunks of items in parallel, and then scatters them in parallel too, each chunk
+ * to its own precomputed offsets, so the result doesn't depend on the number of threads of the pool. Passes where
+ * all the keys share the digit are skipped.
+ */
+template<typename T, typename KeyOf>
+inline void
+radix_sort(std::vector<T>& items, KeyOf keyOf, ThreadPool& pool) {
+    const std::size_t RADIX = 256;
+
+    std::size_t chunksCount = (pool.size() == 1) ? 1 : 4 * pool.size();
+    std::vector<std::size_t> bounds = split_evenly(items.size(), chunksCount);
+    std::vector<std::size_t> offsets(chunksCount * RADIX);
+    std::vector<T> buffer(items.size());
+
+    for (unsigned int shift = 0; shift < 32; shift += 8) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        pool.run(chunksCount, [&](std::size_t c) {
+            std::size_t* counts = &offsets[c * RADIX];
+            for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i)
+                counts[(keyOf(items[i]) >> shift) & (RADIX - 1)]++;
+        });
+
+        // Offsets by digit, and inside a digit by chunk, so the order of the items is kept
+        std::size_t total = 0;
+        bool skip = false;
+        for (std::size_t digit = 0; digit < RADIX; ++digit) {
+            std::size_t digitTotal = 0;
+            for (std::size_t c = 0; c < chunksCount; ++c) {
+                std::size_t count = offsets[c * RADIX + digit];
+                offsets[c * RADIX + digit] = total + digitTotal;
+                digitTotal += count;
+            }
+            skip = skip || digitTotal == items.size();
+            total += digitTotal;
+        }
+        if (skip)
+            continue;
+
+        pool.run(chunksCount, [&](std::size_t c) {
+            std::size_t* next = &offsets[c * RADIX];
+            for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i)
+                buffer[next[(keyOf(items[i]) >> shift) & (RADIX - 1)]++] = items[i];
+        });
+        items.swap(buffer);
+    }
+}
+
+
+}       // namespace parallel
+}       // namespace odsg
+#endif  // SRC_UTILS_PARALLEL_HPP_INCLUDED
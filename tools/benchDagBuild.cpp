@@ -0,0 +1,213 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <exception>
+#include <memory>       // std::auto_ptr
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <chrono>       // for timing
+
+#include <tclap/CmdLine.h>
+
+#include <odsg/ClusteredGraph.hpp>
+#include <odsg/Dag.hpp>
+#include <odsg/Graph.hpp>
+#include <odsg/GraphCluster.hpp>
+#include <odsg/GraphPartitioner.hpp>
+#include <odsg/GraphSnapshot.hpp>
+
+using namespace odsg;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input files
+    std::string graphFileName;
+
+    // Options related to the benchmark itself
+    std::string partitioning;
+    unsigned int minClusterArcs;
+    unsigned int repetitions;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * Build (and free) the dag of each cluster, one at a time; the summaries of all of them are appended to summaries,
+ * to check that both kinds of clusters give the same dags.
+ */
+template<typename Clusters>
+void
+buildDags(const Clusters& clusters, std::size_t count, bool sortedByVertex, std::string& summaries) {
+    std::ostringstream os;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::auto_ptr<const Dag> dag(new Dag(clusters(i), sortedByVertex));
+        os << *dag << '\n';
+    }
+    summaries = os.str();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    Graph graph;
+    try {
+        if (GraphSnapshot::isSnapshot(args.graphFileName))
+            GraphSnapshot(args.graphFileName).load(graph);
+        else
+            graph = Graph(args.graphFileName);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    graph.rebuildForMining(Graph::VertexComparer());
+
+    // A single partition for both ways of building the dags, as some partitioners aren't deterministic
+    std::auto_ptr<GraphPartitioner> partitioner;
+    if (args.partitioning == "HASHING")
+        partitioner.reset(new GraphPartitionerBySignature(&graph));
+    else if (args.partitioning == "TWO_LEVEL_HASHING")
+        partitioner.reset(new GraphPartitionerByTwoLevelShingles(&graph));
+    else
+        partitioner.reset(new GraphPartitionerByInitialOutlink(&graph));
+
+    std::vector<GraphCluster> partition;
+    for (GraphCluster cluster = partitioner->next(args.minClusterArcs); !cluster.empty();
+         cluster = partitioner->next(args.minClusterArcs)) {
+        partition.push_back(cluster);
+    }
+
+    std::cout << graph.listsCount() << " adjacency lists, " << graph.arcsCount() << " arcs, " << partition.size()
+              << " clusters by " << args.partitioning << " partitioning\n";
+
+    double clustersTime = 0.0, layoutTime = 0.0, viewsTime = 0.0;
+    std::string clustersSummaries, viewsSummaries;
+    for (unsigned int rep = 0; rep < args.repetitions; ++rep) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        buildDags([&partition](std::size_t i) -> const GraphCluster& { return partition[i]; },
+                  partition.size(), graph.isSortedByVertex(), clustersSummaries);
+        clustersTime += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        const ClusteredGraph clusteredGraph(partition);
+        layoutTime += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        buildDags([&clusteredGraph](std::size_t i) { return clusteredGraph.cluster(i); },
+                  clusteredGraph.clustersCount(), graph.isSortedByVertex(), viewsSummaries);
+        viewsTime += secondsSince(start);
+
+        std::cerr << "\trepetition " << rep + 1 << " done\n";
+    }
+    bool identical = (clustersSummaries == viewsSummaries);
+
+    clustersTime /= args.repetitions;
+    layoutTime /= args.repetitions;
+    viewsTime /= args.repetitions;
+    std::cout << "dags from GraphCluster:      " << clustersTime << " s\n"
+              << "contiguous layout:           " << layoutTime << " s\n"
+              << "dags from contiguous views:  " << viewsTime << " s\n"
+              << "speedup (without layout):    " << clustersTime / viewsTime << "x\n"
+              << "speedup (with layout):       " << clustersTime / (layoutTime + viewsTime) << "x\n"
+              << "identical dags:              " << (identical ? "yes" : "NO") << '\n';
+
+    return identical ? 0 : 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Benchmark the construction of dags from graph clusters, before and after laying them out"
+                           " contiguously",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    std::vector<std::string> partitioningValues;
+    partitioningValues.push_back("HASHING");
+    partitioningValues.push_back("INITIAL_OUTLINK");
+    partitioningValues.push_back("TWO_LEVEL_HASHING");
+    TCLAP::ValuesConstraint<std::string> partitioningConstraint(partitioningValues);
+    TCLAP::ValueArg<std::string> partitioningArg(
+        "p",
+        "partitioning-scheme",
+        "How the adjacency lists are partitioned in clusters, as in generateComplexes. Defaults to INITIAL_OUTLINK.",
+        false,
+        "INITIAL_OUTLINK",
+        &partitioningConstraint,
+        cmd);
+    TCLAP::ValueArg<unsigned int> minClusterArcsArg(
+        "m",
+        "min-cluster-arcs",
+        "Clusters are merged until having at least this number of arcs. Defaults to 1.",
+        false,
+        1,
+        "ARCS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> repetitionsArg(
+        "n",
+        "repetitions",
+        "Number of times that the dags are built each way; the reported times are averages. Defaults to 3.",
+        false,
+        3,
+        "REPETITIONS",
+        cmd);
+
+    TCLAP::UnlabeledValueArg<std::string> graphFileNameArg(
+        "GRAPH_FILE",
+        "Path to an input text file with a graph, in the format accepted by the Graph constructor, or to a graph"
+            " snapshot (see snapshotGraph).",
+        true,
+        "",
+        "GRAPH_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (graphFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", graphFileNameArg.longID());
+    if (repetitionsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one repetition is required", repetitionsArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.graphFileName  =  graphFileNameArg.getValue();
+    args.partitioning   =   partitioningArg.getValue();
+    args.minClusterArcs = minClusterArcsArg.getValue();
+    args.repetitions    =    repetitionsArg.getValue();
+
+    return args;
+}
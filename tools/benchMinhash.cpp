@@ -0,0 +1,564 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <exception>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <limits.h>
+
+#include <chrono>       // for timing
+
+#include <tclap/CmdLine.h>
+
+#include <clusterGraphs.hpp>
+#include <min.hpp>
+#include <minhash/onePermutation.hpp>
+#include <minhash/signatureMatrix.hpp>
+#include <minhash/signatures.hpp>
+#include <minhash/weighted.hpp>
+#include <odsg/Dag.hpp>
+#include <odsg/DagForest.hpp>
+#include <odsg/DenseSubGraphsMaximalSet.hpp>
+#include <odsg/utils/strings.hpp>
+
+using namespace minhash;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input files
+    std::string datasetFileName;
+
+    // Options related to the benchmark itself
+    unsigned int signaturesCount;
+    unsigned long long seed;
+    unsigned int repetitions;
+    unsigned int maxThreads;
+    bool weighted;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef std::vector<std::vector<long long int> > Rows;
+typedef std::vector<std::vector<Weight> > RowsWeights;
+
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * Read the dataset in the same format used by minhash::min(): one adjacency list of integer ids by line. If
+ * weights isn't NULL, ids alternate with the weights of their interactions, as in the weighted mode of min().
+ */
+Rows
+readRows(const std::string& fileName, RowsWeights* weights=NULL) {
+    std::ifstream infile(fileName.c_str());
+    if (!infile) {
+        throw std::runtime_error("readRows(): can not open input file");
+    }
+
+    Rows rows;
+    std::string line;
+    while (std::getline(infile, line)) {
+        std::istringstream iss(line);
+        std::vector<long long int> row;
+        std::vector<Weight> rowWeights;
+        for (long long int d; iss >> d; ) {
+            row.push_back(d);
+            if (weights) {
+                double w;
+                rowWeights.push_back((iss >> w) ? static_cast<Weight>(w) : Weight(1.0));
+            }
+        }
+        rows.push_back(row);
+        if (weights)
+            weights->push_back(rowWeights);
+    }
+    return rows;
+}
+
+
+/*
+ * The signature computation as it was done originally by minhash::min(): neighbor ids turned into strings,
+ * concatenated by pairs and hashed byte by byte.
+ */
+unsigned
+legacyHashStr(std::string s, int F, int A, int B) {
+    unsigned h = F;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        h = (h * A) ^ (s[i] * B);
+    }
+    return h;
+}
+
+unsigned long long
+legacySignatures(const Rows& rows, unsigned int P) {
+    unsigned long long checksum = 0;
+
+    for (Rows::const_iterator rit = rows.begin(); rit != rows.end(); ++rit) {
+        const std::vector<long long int>& row = *rit;
+
+        std::vector<std::string> ladj;
+        for (std::size_t i = 0; i < row.size(); ++i)
+            ladj.push_back(std::to_string(row[i]));
+
+        for (unsigned int i = 0; i < P; ++i) {
+            long long int c_j = INT_MAX;
+            for (std::size_t j = 0; j + 1 < ladj.size(); ++j) {
+                std::string shingle;
+                shingle.append(ladj[j]);
+                shingle.append(ladj[j + 1]);
+                long long int h = legacyHashStr(shingle, 59 + 22 * i, 7, 13 + 4 * i);
+                c_j = std::min(h, c_j);
+            }
+            checksum += c_j;
+        }
+    }
+    return checksum;
+}
+
+
+template<typename EngineT>
+unsigned long long
+engineSignatures(const Rows& rows, const EngineT& engine, std::vector<Signature>& out) {
+    unsigned long long checksum = 0;
+    std::vector<Id> ids;
+
+    out.resize(rows.size() * engine.size());
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        ids.assign(rows[r].begin(), rows[r].end());
+        engine.sign(ids.data(), ids.data() + ids.size(), &out[r * engine.size()]);
+
+        for (unsigned int k = 0; k < engine.size(); ++k)
+            checksum += out[r * engine.size() + k];
+    }
+    return checksum;
+}
+
+
+/*
+ * Clusters of the rows given by a single table of bands of one signature, signing each row with sign(r, out).
+ */
+template<typename SignT>
+std::vector<std::vector<int> >
+bandClusters(std::size_t rowsCount, unsigned int signaturesCount, SignT sign) {
+    BandTables tables(signaturesCount, 1);
+    std::vector<Signature> hashes(signaturesCount);
+    for (std::size_t r = 0; r < rowsCount; ++r) {
+        sign(r, hashes.data());
+        tables.insert(static_cast<int>(r), hashes.data());
+    }
+    return tables.clusters();
+}
+
+
+void
+printClustersSizes(const char* name, const std::vector<std::vector<int> >& clusters, double time) {
+    std::size_t members = 0, biggest = 0;
+    std::vector<std::size_t> histogram(5, 0);       // Sizes 2, 3-4, 5-8, 9-16, and more than 16
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+        std::size_t size = clusters[i].size();
+        members += size;
+        biggest = std::max(biggest, size);
+        histogram[size <= 2 ? 0 : size <= 4 ? 1 : size <= 8 ? 2 : size <= 16 ? 3 : 4]++;
+    }
+    std::cout << name << time << " s, " << clusters.size() << " clusters, mean size "
+              << (clusters.empty() ? 0.0 : double(members) / clusters.size()) << ", max size " << biggest
+              << ", sizes 2 / 3-4 / 5-8 / 9-16 / 17+: " << histogram[0] << " / " << histogram[1] << " / "
+              << histogram[2] << " / " << histogram[3] << " / " << histogram[4] << '\n';
+}
+
+
+/*
+ * Whether a SignatureMatrix of 32-bit signatures, keeping all the rows of its buckets, gives the same clusters as
+ * the band tables used by minhash::min() at 32 bits, from the same signatures (signaturesCount by row).
+ */
+bool
+matrixCheck(const std::vector<Signature>& signatures, std::size_t rowsCount, unsigned int signaturesCount) {
+    BandTables tables(signaturesCount, 1);
+    SignatureMatrix matrix(signaturesCount, 32);
+    for (std::size_t r = 0; r < rowsCount; ++r) {
+        tables.insert(static_cast<int>(r), &signatures[r * signaturesCount]);
+        matrix.insert(static_cast<int>(r), &signatures[r * signaturesCount]);
+    }
+
+    // Any two rows have a similarity above -1, so all the rows of each bucket are linked
+    bool same = (matrix.clusters(signaturesCount, 1, -1.0) == tables.clusters());
+    std::cout << "32-bit matrix:     same clusters as the band tables: " << (same ? "yes" : "NO") << '\n';
+    return same;
+}
+
+
+/*
+ * Time to mine the dense subgraphs of the graphs of the clusters, built and mined as generateComplexes does by
+ * default with USYM graphs: the cost that the sizes of the clusters turn into.
+ */
+double
+miningTime(const std::vector<std::vector<int> >& clusters, const Adjacency& adjacency, std::size_t& denseSubGraphs) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    bio_odsg::ProteinsMap mapping;
+    std::vector<odsg::WGraph> graphs = bio_odsg::buildClustersWGraphs(clusters, adjacency, mapping);
+
+    const unsigned int objective = 4;       // WDEGREE, the default weight-density metric
+    denseSubGraphs = 0;
+    for (std::size_t i = 0; i < graphs.size(); ++i) {
+        graphs[i].rebuildForMining();
+        if (graphs[i].empty())
+            continue;
+        odsg::DagForest::stream(graphs[i], [&](const odsg::Dag& dag) {
+            denseSubGraphs += dag.getDenseSubGraphs(0, objective, false, 1).size();
+        }, 1);
+    }
+    return secondsSince(start);
+}
+
+
+/*
+ * Signing and clustering time, and the distribution of the sizes of the clusters, with weighted MinHash against
+ * the unweighted signatures of the same rows; and the time to mine the clusters of both, that grows with their
+ * sizes. The interactions weigh the same in the graphs of both, as with the --weighted-minhash option of
+ * generateComplexes.
+ */
+void
+weightedComparison(const CmdLineArgs& args, const Rows& rows, const RowsWeights& weights) {
+    const SignatureEngine engine(args.signaturesCount, args.seed);
+    const WeightedSignatureEngine weightedEngine(args.signaturesCount, args.seed);
+    std::vector<Id> ids;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::vector<int> > clusters = bandClusters(rows.size(), args.signaturesCount,
+        [&](std::size_t r, Signature* out) {
+            ids.assign(rows[r].begin(), rows[r].end());
+            engine.sign(ids.data(), ids.data() + ids.size(), out);
+        });
+    double time = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<int> > weightedClusters = bandClusters(rows.size(), args.signaturesCount,
+        [&](std::size_t r, Signature* out) {
+            ids.assign(rows[r].begin(), rows[r].end());
+            weightedEngine.sign(ids.data(), ids.data() + ids.size(), weights[r].data(), out);
+        });
+    double weightedTime = secondsSince(start);
+
+    std::cout << "\nClustering with " << args.signaturesCount << " bands of 1 signature:\n";
+    printClustersSizes("unweighted:        ", clusters, time);
+    printClustersSizes("weighted (ICWS):   ", weightedClusters, weightedTime);
+
+    Adjacency adjacency;
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        for (std::size_t j = 0; j < rows[r].size(); ++j)
+            adjacency.addNeighbor(static_cast<Id>(rows[r][j]), weights[r][j]);
+        adjacency.closeRow();
+    }
+
+    std::size_t denseSubGraphs, weightedDenseSubGraphs;
+    time = miningTime(clusters, adjacency, denseSubGraphs);
+    weightedTime = miningTime(weightedClusters, adjacency, weightedDenseSubGraphs);
+    std::cout << "\nMining the graphs of the clusters:\n"
+              << "unweighted:        " << time << " s, " << denseSubGraphs << " dense subgraphs\n"
+              << "weighted (ICWS):   " << weightedTime << " s, " << weightedDenseSubGraphs << " dense subgraphs\n";
+}
+
+
+/*
+ * Wall time of the whole minhash::min() for 1, 2, 4... up to maxThreads threads. The clusters must be identical
+ * to those of the sequential run.
+ */
+bool
+threadsScaling(const CmdLineArgs& args) {
+    minhash::Parameters params;
+    params.bands = args.signaturesCount;
+    params.seed = args.seed;
+    params.weighted = args.weighted;
+
+    std::vector<unsigned int> threadsCounts;
+    for (unsigned int threads = 1; threads < args.maxThreads; threads *= 2)
+        threadsCounts.push_back(threads);
+    threadsCounts.push_back(args.maxThreads);
+
+    std::cout << "\nminhash::min() with " << params.bands << " bands of 1 signature:\n"
+              << "threads\tseconds\tspeedup\tidentical\n";
+
+    bool allIdentical = true;
+    double sequentialTime = 0.0;
+    std::vector<std::vector<int> > sequentialClusters;
+    for (std::size_t i = 0; i < threadsCounts.size(); ++i) {
+        params.threads = threadsCounts[i];
+
+        double time = 0.0;
+        std::vector<std::vector<int> > clusters;
+        for (unsigned int rep = 0; rep < args.repetitions; ++rep) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            clusters = minhash::min(args.datasetFileName, params).clusters;
+            time += secondsSince(start);
+        }
+        time /= args.repetitions;
+
+        if (i == 0) {
+            sequentialTime = time;
+            sequentialClusters = clusters;
+        }
+        bool identical = (clusters == sequentialClusters);
+        allIdentical = allIdentical && identical;
+
+        std::cout << params.threads << '\t' << time << '\t' << sequentialTime / time << '\t'
+                  << (identical ? "yes" : "NO") << '\n';
+    }
+    return allIdentical;
+}
+
+
+/*
+ * Whether every member of the clusters of minhash::min() brings its own adjacency list to the graph that
+ * bio_odsg::buildClustersWGraphs() builds for its cluster: the list of the member in the graph must have all the
+ * neighbors of its row. Members of the clusters after the last closed one don't get any graph, and are skipped.
+ */
+bool
+clustersGraphsCheck(const CmdLineArgs& args) {
+    minhash::Parameters params;
+    params.bands = args.signaturesCount;
+    params.seed = args.seed;
+    params.weighted = args.weighted;
+    const minhash::Result result = minhash::min(args.datasetFileName, params);
+
+    bio_odsg::ProteinsMap mapping;
+    const std::vector<odsg::WGraph> graphs = bio_odsg::buildClustersWGraphs(result.clusters, result.graph, mapping);
+
+    bool matching = true;
+    std::size_t graph = 0, first = 0;       // The clusters from first to i go to the same graph
+    for (std::size_t i = 0; i < result.clusters.size() && graph < graphs.size(); ++i) {
+        bool closed = true;
+        for (std::size_t j = 0; j < result.clusters[i].size(); ++j) {
+            if (result.graph.degree(static_cast<std::size_t>(result.clusters[i][j])) < 3)
+                closed = false;     // The same rule used by buildClustersWGraphs()
+        }
+        if (!closed)
+            continue;
+
+        for (std::size_t c = first; c <= i; ++c) {
+            for (std::size_t j = 0; j < result.clusters[c].size(); ++j) {
+                std::size_t row = static_cast<std::size_t>(result.clusters[c][j]);
+                odsg::Graph::const_iterator list = graphs[graph].find(mapping[odsg::strings::to_str(row)]);
+                if (list == graphs[graph].end()) {
+                    matching = false;
+                    continue;
+                }
+                for (const Id* it = result.graph.row(row); it != result.graph.rowEnd(row); ++it) {
+                    odsg::Vertex neighbor = mapping[odsg::strings::to_str(*it)];
+                    if (std::find(list->second.begin(), list->second.end(), neighbor) == list->second.end())
+                        matching = false;
+                }
+            }
+        }
+        ++graph;
+        first = i + 1;
+    }
+
+    std::cout << "\nGraphs of the clusters: " << graphs.size() << " of " << result.clusters.size()
+              << " clusters, members with their own adjacency lists: " << (matching ? "yes" : "NO") << '\n';
+    return matching;
+}
+
+
+const char*
+simdKernelName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE4_1__)
+    return "SSE4.1";
+#else
+    return "scalar";
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    Rows rows;
+    RowsWeights weights;
+    try {
+        rows = readRows(args.datasetFileName, args.weighted ? &weights : NULL);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+
+    unsigned long long shingles = 0;
+    for (Rows::const_iterator rit = rows.begin(); rit != rows.end(); ++rit) {
+        if (rit->size() >= 2)
+            shingles += rit->size() - 1;
+    }
+    std::cout << rows.size() << " rows, " << shingles << " 2-shingles, "
+              << args.signaturesCount << " signatures by row, min-reduction kernel: " << simdKernelName() << '\n';
+
+    double legacyTime = 0.0, engineTime = 0.0, onePermutationTime = 0.0;
+    std::vector<Signature> first, again, onePermutation;
+    const SignatureEngine engine(args.signaturesCount, args.seed);
+    const OnePermutationEngine onePermutationEngine(args.signaturesCount, args.seed);
+
+    for (unsigned int rep = 0; rep < args.repetitions; ++rep) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long long legacyChecksum = legacySignatures(rows, args.signaturesCount);
+        legacyTime += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        unsigned long long engineChecksum = engineSignatures(rows, engine, rep == 0 ? first : again);
+        engineTime += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        engineSignatures(rows, onePermutationEngine, onePermutation);
+        onePermutationTime += secondsSince(start);
+
+        std::cerr << "\trepetition " << rep + 1 << ": checksums " << legacyChecksum << " / " << engineChecksum << '\n';
+    }
+
+    // The signatures must be bit-identical between repetitions, and for a fresh engine with the same seed
+    std::vector<Signature> fresh;
+    engineSignatures(rows, SignatureEngine(args.signaturesCount, args.seed), fresh);
+    bool identical = (fresh == first) && (args.repetitions < 2 || again == first);
+
+    legacyTime /= args.repetitions;
+    engineTime /= args.repetitions;
+    onePermutationTime /= args.repetitions;
+    std::cout << "legacy (strings):  " << legacyTime << " s, " << shingles * args.signaturesCount / legacyTime
+              << " shingle-hashes/s\n"
+              << "integer engine:    " << engineTime << " s, " << shingles * args.signaturesCount / engineTime
+              << " shingle-hashes/s\n"
+              << "one permutation:   " << onePermutationTime << " s, " << shingles / onePermutationTime
+              << " shingles/s\n"
+              << "speedup:           " << legacyTime / engineTime << "x (integer engine), "
+              << legacyTime / onePermutationTime << "x (one permutation)\n"
+              << "deterministic:     " << (identical ? "yes" : "NO") << '\n';
+
+    if (!matrixCheck(first, rows.size(), args.signaturesCount))
+        identical = false;
+
+    if (args.weighted) {
+        weightedComparison(args, rows, weights);
+    }
+
+    rows.clear();
+    weights.clear();
+    if (!clustersGraphsCheck(args))
+        identical = false;
+
+    if (args.maxThreads > 0) {
+        if (!threadsScaling(args))
+            identical = false;
+    }
+
+    return identical ? 0 : 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Benchmark the throughput of the MinHash signatures computation used to cluster datasets",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    TCLAP::ValueArg<unsigned int> signaturesCountArg(
+        "k",
+        "signatures",
+        "Number of MinHash signatures computed by adjacency list. Defaults to 2.",
+        false,
+        2,
+        "SIGNATURES",
+        cmd);
+    TCLAP::ValueArg<unsigned long long> seedArg(
+        "",
+        "seed",
+        "Seed for the family of hash functions of the integer engine.",
+        false,
+        DEFAULT_SEED,
+        "SEED",
+        cmd);
+    TCLAP::ValueArg<unsigned int> repetitionsArg(
+        "n",
+        "repetitions",
+        "Number of times that each implementation is run; the reported times are averages. Defaults to 3.",
+        false,
+        3,
+        "REPETITIONS",
+        cmd);
+
+    TCLAP::ValueArg<unsigned int> maxThreadsArg(
+        "t",
+        "threads-scaling",
+        "Also measure the scaling of the whole minhash::min() from 1 thread up to the given number of threads,"
+            " using the -k option as the number of bands. Disabled by default.",
+        false,
+        0,
+        "MAX_THREADS",
+        cmd);
+
+    TCLAP::SwitchArg weightedArg(
+        "w",
+        "weighted",
+        "The dataset has weighted interactions, as accepted by the weighted mode of minhash::min(). Also compare the"
+            " clusters given by weighted MinHash with the unweighted ones.",
+        cmd,
+        false);
+
+    TCLAP::UnlabeledValueArg<std::string> datasetFileNameArg(
+        "DATASET_FILE",
+        "Path to an input text file with one adjacency list of integer ids by line, as accepted by minhash::min().",
+        true,
+        "",
+        "DATASET_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (datasetFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", datasetFileNameArg.longID());
+    if (signaturesCountArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one signature is required", signaturesCountArg.longID());
+    if (repetitionsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one repetition is required", repetitionsArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.datasetFileName = datasetFileNameArg.getValue();
+    args.signaturesCount = signaturesCountArg.getValue();
+    args.seed            =            seedArg.getValue();
+    args.repetitions     =     repetitionsArg.getValue();
+    args.maxThreads      =      maxThreadsArg.getValue();
+    args.weighted        =        weightedArg.getValue();
+
+    return args;
+}
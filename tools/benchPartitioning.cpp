@@ -0,0 +1,568 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <cerrno>
+#include <exception>
+#include <memory>       // std::auto_ptr
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <random>       // std::mt19937_64
+
+#include <chrono>       // for timing
+#include <sys/resource.h>   // struct rusage
+#include <sys/types.h>
+#include <sys/wait.h>       // wait4
+#include <unistd.h>         // fork, pipe
+
+#include <tclap/CmdLine.h>
+
+#include <odsg/Dag.hpp>
+#include <odsg/DenseSubGraphsMaximalSet.hpp>
+#include <odsg/Graph.hpp>
+#include <odsg/GraphCluster.hpp>
+#include <odsg/GraphPartitioner.hpp>
+#include <odsg/GraphSnapshot.hpp>
+#include <odsg/VertexSet.hpp>
+
+using namespace odsg;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input files
+    std::string graphFileName;
+
+    // Options related to the synthetic graph, used when no graph file is given
+    unsigned int syntheticVertexes;
+    unsigned int syntheticDegree;
+    unsigned long long seed;
+
+    // Options related to the benchmark itself
+    std::vector<std::string> schemes;
+    std::vector<std::string> sortings;
+    std::vector<unsigned int> minClusterSizes;
+
+    // Output
+    std::string format;
+    std::string outputFileName;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * A random undirected graph where each vertex has about degree neighbors, plus a clique of 8 vertexes every 64
+ * vertexes, so there is something dense to mine.
+ */
+Graph
+syntheticGraph(unsigned int vertexes, unsigned int degree, unsigned long long seed) {
+    std::mt19937_64 random(seed);
+    std::map<Vertex, VertexSet> lists;
+
+    for (Vertex vx = 0; vx < vertexes; ++vx) {
+        for (unsigned int d = 0; d < degree / 2; ++d) {
+            Vertex neighbor = static_cast<Vertex>(random() % vertexes);
+            if (neighbor == vx)
+                continue;
+            lists[vx].insert(neighbor);
+            lists[neighbor].insert(vx);
+        }
+    }
+    for (Vertex first = 0; first + 8 <= vertexes; first += 64) {
+        for (Vertex vx = first; vx < first + 8; ++vx) {
+            for (Vertex neighbor = first; neighbor < first + 8; ++neighbor) {
+                if (neighbor != vx)
+                    lists[vx].insert(neighbor);
+            }
+        }
+    }
+    return Graph(lists);
+}
+
+
+struct Result {
+    std::string scheme;
+    std::string sorting;
+    unsigned int minClusterSize;
+
+    double rebuildTime;
+    double partitionTime;
+    double dagsTime;
+    double miningTime;
+    long peakRssKb;
+
+    std::vector<std::size_t> clustersHistogram;     // Clusters by arcs count: 1, 2-3, 4-7, 8-15...
+    std::size_t clustersCount;
+
+    unsigned int minDagDepth;
+    unsigned int maxDagDepth;
+    double meanDagDepth;
+
+    unsigned long long denseSubGraphs;
+};
+
+
+int
+schemeNumber(const std::string& scheme) {     // As DagForest clusteringScheme
+    if (scheme == "INITIAL_OUTLINK")
+        return 1;
+    if (scheme == "HASHING")
+        return 2;
+    if (scheme == "TWO_LEVEL_HASHING")
+        return 3;
+    return 0;
+}
+
+
+/*
+ * Build and mine a dag, updating the statistics of the result. A Dag built from a whole graph asks it whether it
+ * is sorted by vertex.
+ */
+const Dag*
+newDag(const Graph& graph, bool) { return new Dag(graph); }
+
+const Dag*
+newDag(const GraphCluster& cluster, bool sortedByVertex) { return new Dag(cluster, sortedByVertex); }
+
+template<typename GraphT>
+void
+buildAndMine(const GraphT& source, bool sortedByVertex, Result& result) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::auto_ptr<const Dag> dag(newDag(source, sortedByVertex));
+    result.dagsTime += secondsSince(start);
+
+    unsigned int depth = dag->maxDepth();
+    result.minDagDepth = (result.clustersCount == 0 || depth < result.minDagDepth) ? depth : result.minDagDepth;
+    result.maxDagDepth = (depth > result.maxDagDepth) ? depth : result.maxDagDepth;
+    result.meanDagDepth += depth;
+
+    start = std::chrono::steady_clock::now();
+    result.denseSubGraphs += dag->getDenseSubGraphs(0, 0, false, 1).size();
+    result.miningTime += secondsSince(start);
+
+    std::size_t range = 0;
+    while ((source.arcsCount() >> (range + 1)) > 0)
+        ++range;
+    if (result.clustersHistogram.size() <= range)
+        result.clustersHistogram.resize(range + 1, 0);
+    result.clustersHistogram[range]++;
+    result.clustersCount++;
+}
+
+
+/*
+ * Run a combination on a fresh copy of the graph: rebuild it for mining with the given sorting, partition it
+ * (the same as DagForest does), and build and mine the dag of each cluster, one at a time.
+ */
+Result
+run(const Graph& original, const std::string& scheme, const std::string& sorting, unsigned int minClusterSize,
+    unsigned long long seed) {
+    Result result = Result();
+    result.scheme = scheme;
+    result.sorting = sorting;
+    result.minClusterSize = minClusterSize;
+
+    Graph graph = original;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (sorting == "ID") {
+        graph.rebuildForMining(Graph::VertexComparer());
+    } else {
+        graph.rebuildForMiningExceptSorting();      // Required by both comparers
+        if (sorting == "FREQUENCY")
+            graph.rebuildForMining(Graph::VertexFrequencyComparer(graph));
+        else
+            graph.rebuildForMining(Graph::RandomVertexPermutationComparer(graph, seed));
+    }
+    result.rebuildTime = secondsSince(start);
+
+    std::auto_ptr<GraphPartitioner> partitioner;
+    switch (schemeNumber(scheme)) {
+        case 1:     partitioner.reset(new GraphPartitionerByInitialOutlink(&graph));
+                    break;
+        case 2:     partitioner.reset(new GraphPartitionerBySignature(&graph));
+                    break;
+        case 3:     partitioner.reset(new GraphPartitionerByTwoLevelShingles(&graph));
+                    break;
+    }
+
+    start = std::chrono::steady_clock::now();
+    std::vector<GraphCluster> partition;
+    if (partitioner.get() && !graph.empty()) {
+        for (GraphCluster cluster = partitioner->next(minClusterSize); !cluster.empty();
+             cluster = partitioner->next(minClusterSize)) {
+            partition.push_back(cluster);
+        }
+    }
+    result.partitionTime = secondsSince(start);
+
+    if (partition.empty()) {
+        if (!graph.empty())
+            buildAndMine(graph, graph.isSortedByVertex(), result);
+    } else {
+        for (std::vector<GraphCluster>::const_iterator it = partition.begin(); it != partition.end(); ++it)
+            buildAndMine(*it, graph.isSortedByVertex(), result);
+    }
+    if (result.clustersCount > 0)
+        result.meanDagDepth /= result.clustersCount;
+
+    return result;
+}
+
+
+/*
+ * The same, in a child process, so the peak resident set size of the combination is that of its own process
+ * (getrusage() only gives the peak of a process so far, that never decreases). The child inherits the graph, so
+ * its peak counts the original graph too. The measures of the child come back by a pipe.
+ */
+bool
+runInChild(const Graph& original, const std::string& scheme, const std::string& sorting, unsigned int minClusterSize,
+           unsigned long long seed, Result& result) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        std::ostringstream oss;
+        try {
+            Result child = run(original, scheme, sorting, minClusterSize, seed);
+            oss.precision(std::numeric_limits<double>::max_digits10);
+            oss << child.rebuildTime << ' ' << child.partitionTime << ' ' << child.dagsTime << ' '
+                << child.miningTime << ' ' << child.clustersCount << ' ' << child.minDagDepth << ' '
+                << child.maxDagDepth << ' ' << child.meanDagDepth << ' ' << child.denseSubGraphs << ' '
+                << child.clustersHistogram.size();
+            for (std::size_t range = 0; range < child.clustersHistogram.size(); ++range)
+                oss << ' ' << child.clustersHistogram[range];
+        } catch (std::exception& e) {
+            std::cerr << "ERROR\n" << e.what() << std::endl;
+            _exit(1);
+        }
+
+        const std::string measures = oss.str();
+        for (std::size_t written = 0; written < measures.size(); ) {
+            ssize_t n = write(fds[1], measures.data() + written, measures.size() - written);
+            if (n <= 0)
+                _exit(1);
+            written += static_cast<std::size_t>(n);
+        }
+        _exit(0);       // Without flushing the buffers inherited from the parent
+    }
+
+    close(fds[1]);
+    std::string measures;
+    char buffer[4096];
+    for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) != 0; ) {
+        if (n > 0)
+            measures.append(buffer, static_cast<std::size_t>(n));
+        else if (errno != EINTR)
+            break;
+    }
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return false;
+
+    result = Result();
+    result.scheme = scheme;
+    result.sorting = sorting;
+    result.minClusterSize = minClusterSize;
+    result.peakRssKb = usage.ru_maxrss;
+
+    std::istringstream iss(measures);
+    std::size_t ranges = 0;
+    iss >> result.rebuildTime >> result.partitionTime >> result.dagsTime >> result.miningTime
+        >> result.clustersCount >> result.minDagDepth >> result.maxDagDepth >> result.meanDagDepth
+        >> result.denseSubGraphs >> ranges;
+    result.clustersHistogram.resize(ranges, 0);
+    for (std::size_t range = 0; range < ranges; ++range)
+        iss >> result.clustersHistogram[range];
+    return static_cast<bool>(iss);
+}
+
+
+/*
+ * Output, one line by result for CSV, or an array of objects for JSON.
+ */
+std::string
+histogramRange(std::size_t range) {
+    std::size_t first = std::size_t(1) << range;
+    return range == 0 ? "1" : std::to_string(first) + "-" + std::to_string(2 * first - 1);
+}
+
+void
+printCsvHeader(std::ostream& os) {
+    os << "scheme,sorting,min_cluster_size,rebuild_s,partition_s,dags_s,mining_s,peak_rss_kb,clusters,"
+          "clusters_by_arcs,dag_depth_min,dag_depth_mean,dag_depth_max,dense_subgraphs\n";
+}
+
+void
+printCsv(std::ostream& os, const Result& result) {
+    os << result.scheme << ',' << result.sorting << ',' << result.minClusterSize << ','
+       << result.rebuildTime << ',' << result.partitionTime << ',' << result.dagsTime << ',' << result.miningTime << ','
+       << result.peakRssKb << ',' << result.clustersCount << ',';
+    for (std::size_t range = 0; range < result.clustersHistogram.size(); ++range) {
+        if (range > 0)
+            os << ' ';
+        os << histogramRange(range) << ':' << result.clustersHistogram[range];
+    }
+    os << ',' << result.minDagDepth << ',' << result.meanDagDepth << ',' << result.maxDagDepth << ','
+       << result.denseSubGraphs << '\n';
+}
+
+void
+printJson(std::ostream& os, const Result& result, bool last) {
+    os << "  {\"scheme\": \"" << result.scheme << "\", \"sorting\": \"" << result.sorting
+       << "\", \"min_cluster_size\": " << result.minClusterSize
+       << ",\n   \"rebuild_s\": " << result.rebuildTime << ", \"partition_s\": " << result.partitionTime
+       << ", \"dags_s\": " << result.dagsTime << ", \"mining_s\": " << result.miningTime
+       << ", \"peak_rss_kb\": " << result.peakRssKb
+       << ",\n   \"clusters\": " << result.clustersCount << ", \"clusters_by_arcs\": {";
+    for (std::size_t range = 0; range < result.clustersHistogram.size(); ++range) {
+        if (range > 0)
+            os << ", ";
+        os << '"' << histogramRange(range) << "\": " << result.clustersHistogram[range];
+    }
+    os << "},\n   \"dag_depth_min\": " << result.minDagDepth << ", \"dag_depth_mean\": " << result.meanDagDepth
+       << ", \"dag_depth_max\": " << result.maxDagDepth << ", \"dense_subgraphs\": " << result.denseSubGraphs
+       << '}' << (last ? "\n" : ",\n");
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    Graph graph;
+    if (args.graphFileName.empty()) {
+        graph = syntheticGraph(args.syntheticVertexes, args.syntheticDegree, args.seed);
+    } else {
+        try {
+            if (GraphSnapshot::isSnapshot(args.graphFileName))
+                GraphSnapshot(args.graphFileName).load(graph);
+            else
+                graph = Graph(args.graphFileName);
+        } catch (std::exception& e) {
+            std::cerr << "ERROR\n" << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::cerr << graph.listsCount() << " adjacency lists, " << graph.arcsCount() << " arcs\n";
+
+    std::ofstream outfile;
+    if (!args.outputFileName.empty()) {
+        outfile.open(args.outputFileName.c_str());
+        if (!outfile) {
+            std::cerr << "error: can not open output file" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = outfile.is_open() ? outfile : std::cout;
+
+    const std::size_t combinations = args.schemes.size() * args.sortings.size() * args.minClusterSizes.size();
+    std::size_t done = 0;
+
+    if (args.format == "CSV")
+        printCsvHeader(os);
+    else
+        os << "[\n";
+    for (std::vector<std::string>::const_iterator scheme = args.schemes.begin(); scheme != args.schemes.end();
+         ++scheme) {
+        for (std::vector<std::string>::const_iterator sorting = args.sortings.begin();
+             sorting != args.sortings.end(); ++sorting) {
+            for (std::vector<unsigned int>::const_iterator minSize = args.minClusterSizes.begin();
+                 minSize != args.minClusterSizes.end(); ++minSize) {
+                std::cerr << '\t' << *scheme << ", " << *sorting << ", " << *minSize << std::endl;
+
+                Result result;
+                if (!runInChild(graph, *scheme, *sorting, *minSize, args.seed, result)) {
+                    std::cerr << "error: the combination failed" << std::endl;
+                    return 1;
+                }
+                if (args.format == "CSV")
+                    printCsv(os, result);
+                else
+                    printJson(os, result, ++done == combinations);
+                os << std::flush;
+            }
+        }
+    }
+    if (args.format != "CSV")
+        os << "]\n";
+
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Benchmark the partitioning schemes, adjacency lists sortings and minimum cluster sizes used"
+                           " to build and mine the dags of a graph",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    std::vector<std::string> schemeValues;
+    schemeValues.push_back("NONE");
+    schemeValues.push_back("INITIAL_OUTLINK");
+    schemeValues.push_back("HASHING");
+    schemeValues.push_back("TWO_LEVEL_HASHING");
+    TCLAP::ValuesConstraint<std::string> schemeConstraint(schemeValues);
+    TCLAP::MultiArg<std::string> schemesArg(
+        "p",
+        "partitioning-scheme",
+        "A partitioning scheme to run, as in generateComplexes; it can be repeated. Defaults to NONE,"
+            " INITIAL_OUTLINK and HASHING.",
+        false,
+        &schemeConstraint,
+        cmd);
+
+    std::vector<std::string> sortingValues;
+    sortingValues.push_back("ID");
+    sortingValues.push_back("FREQUENCY");
+    sortingValues.push_back("RANDOM");
+    TCLAP::ValuesConstraint<std::string> sortingConstraint(sortingValues);
+    TCLAP::MultiArg<std::string> sortingsArg(
+        "r",
+        "outlinks-sorting",
+        "A sorting of the adjacency lists to run, as in generateComplexes, plus RANDOM (a random permutation of the"
+            " ids); it can be repeated. Defaults to all of them.",
+        false,
+        &sortingConstraint,
+        cmd);
+    TCLAP::MultiArg<unsigned int> minClusterSizesArg(
+        "m",
+        "min-cluster-size",
+        "A minimum number of arcs by cluster to run; it can be repeated. Defaults to 1, 10 and 100.",
+        false,
+        "ARCS",
+        cmd);
+
+    TCLAP::ValueArg<unsigned int> syntheticVertexesArg(
+        "n",
+        "synthetic-vertexes",
+        "Number of vertexes of the synthetic graph used when no graph file is given. Defaults to 10000.",
+        false,
+        10000,
+        "VERTEXES",
+        cmd);
+    TCLAP::ValueArg<unsigned int> syntheticDegreeArg(
+        "d",
+        "synthetic-degree",
+        "Average degree of the synthetic graph. Defaults to 10.",
+        false,
+        10,
+        "DEGREE",
+        cmd);
+    TCLAP::ValueArg<unsigned long long> seedArg(
+        "",
+        "seed",
+        "Seed for the synthetic graph and for the RANDOM sorting.",
+        false,
+        1,
+        "SEED",
+        cmd);
+
+    std::vector<std::string> formatValues;
+    formatValues.push_back("CSV");
+    formatValues.push_back("JSON");
+    TCLAP::ValuesConstraint<std::string> formatConstraint(formatValues);
+    TCLAP::ValueArg<std::string> formatArg(
+        "f",
+        "format",
+        "Format of the results. Defaults to CSV.",
+        false,
+        "CSV",
+        &formatConstraint,
+        cmd);
+    TCLAP::ValueArg<std::string> outputFileNameArg(
+        "o",
+        "output",
+        "Path to the output file with the results. Defaults to the standard output.",
+        false,
+        "",
+        "OUTPUT_FILE",
+        cmd);
+
+    TCLAP::UnlabeledValueArg<std::string> graphFileNameArg(
+        "GRAPH_FILE",
+        "Path to an input text file with a graph, in the format accepted by the Graph constructor, or to a graph"
+            " snapshot (see snapshotGraph). If not given, a synthetic graph is used.",
+        false,
+        "",
+        "GRAPH_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (graphFileNameArg.getValue().empty() && syntheticVertexesArg.getValue() < 2)
+        throw TCLAP::CmdLineParseException("The synthetic graph needs at least two vertexes",
+                                           syntheticVertexesArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.graphFileName     =     graphFileNameArg.getValue();
+    args.syntheticVertexes = syntheticVertexesArg.getValue();
+    args.syntheticDegree   =   syntheticDegreeArg.getValue();
+    args.seed              =              seedArg.getValue();
+    args.schemes           =           schemesArg.getValue();
+    args.sortings          =          sortingsArg.getValue();
+    args.minClusterSizes   =   minClusterSizesArg.getValue();
+    args.format            =            formatArg.getValue();
+    args.outputFileName    =    outputFileNameArg.getValue();
+
+    if (args.schemes.empty()) {
+        args.schemes.push_back("NONE");
+        args.schemes.push_back("INITIAL_OUTLINK");
+        args.schemes.push_back("HASHING");
+    }
+    if (args.sortings.empty())
+        args.sortings = sortingValues;
+    if (args.minClusterSizes.empty()) {
+        args.minClusterSizes.push_back(1);
+        args.minClusterSizes.push_back(10);
+        args.minClusterSizes.push_back(100);
+    }
+
+    return args;
+}
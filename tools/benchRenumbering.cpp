@@ -0,0 +1,210 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <exception>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>      // std::setprecision
+
+#include <chrono>       // for timing
+
+#include <tclap/CmdLine.h>
+
+#include <odsg/Dag.hpp>
+#include <odsg/DagForest.hpp>
+#include <odsg/DenseSubGraphsMaximalSet.hpp>
+#include <odsg/Graph.hpp>
+#include <odsg/VertexRenumbering.hpp>
+
+using namespace odsg;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input files
+    std::string graphFileName;
+
+    // Options related to the benchmark itself
+    int partitioning;
+    unsigned int repetitions;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+struct Timings {
+    double renumbering;
+    double rebuild;
+    double dags;
+    double mining;
+    unsigned long long denseSubGraphs;
+    unsigned long long denseSubGraphsArcs;
+};
+
+
+/*
+ * Renumber (unless order is empty), rebuild for mining, and build and mine the dags of a fresh copy of the graph.
+ */
+Timings
+run(const Graph& original, const std::string& order, int partitioning) {
+    Timings timings = Timings();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Graph graph = original;
+    if (!order.empty()) {
+        const VertexRenumbering renumbering(original, VertexRenumbering::toOrder(order));
+        graph = renumbering.apply(original);
+    }
+    timings.renumbering = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    graph.rebuildForMining(Graph::VertexComparer());
+    timings.rebuild = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    DagForest::stream(graph, [&timings](const Dag& dag) {
+        std::chrono::steady_clock::time_point miningStart = std::chrono::steady_clock::now();
+        const DenseSubGraphsMaximalSet dsgs = dag.getDenseSubGraphs(0, 0, false, 1);
+        timings.mining += secondsSince(miningStart);
+
+        for (DenseSubGraphsMaximalSet::const_iterator it = dsgs.begin(); it != dsgs.end(); ++it) {
+            timings.denseSubGraphs++;
+            timings.denseSubGraphsArcs += it->arcsCount();
+        }
+    }, partitioning);
+    timings.dags = secondsSince(start) - timings.mining;
+
+    return timings;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    Graph graph;
+    try {
+        graph = Graph(args.graphFileName);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << graph.listsCount() << " adjacency lists, " << graph.arcsCount() << " arcs; times in seconds\n"
+              << "order            renumber  rebuild   dags      mining    dense subgraphs (arcs)\n"
+              << std::fixed << std::setprecision(4);
+
+    std::vector<std::string> orders;
+    orders.push_back("");       // Original ids
+    orders.push_back(VertexRenumbering::toString(VertexRenumbering::DEGREE));
+    orders.push_back(VertexRenumbering::toString(VertexRenumbering::CUTHILL_MCKEE));
+    orders.push_back(VertexRenumbering::toString(VertexRenumbering::COMMUNITY));
+
+    for (std::vector<std::string>::const_iterator it = orders.begin(); it != orders.end(); ++it) {
+        Timings total = Timings();
+        for (unsigned int rep = 0; rep < args.repetitions; ++rep) {
+            Timings timings = run(graph, *it, args.partitioning);
+            total.renumbering += timings.renumbering;
+            total.rebuild += timings.rebuild;
+            total.dags += timings.dags;
+            total.mining += timings.mining;
+            total.denseSubGraphs = timings.denseSubGraphs;
+            total.denseSubGraphsArcs = timings.denseSubGraphsArcs;
+        }
+
+        std::string name = it->empty() ? "NONE" : *it;
+        name.resize(16, ' ');
+        std::cout << name << ' ' << std::setw(8) << total.renumbering / args.repetitions
+                  << "  " << std::setw(8) << total.rebuild / args.repetitions
+                  << "  " << std::setw(8) << total.dags / args.repetitions
+                  << "  " << std::setw(8) << total.mining / args.repetitions
+                  << "  " << total.denseSubGraphs << " (" << total.denseSubGraphsArcs << ")\n";
+    }
+
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Benchmark the effect of renumbering the vertexes of a graph on rebuilding it for mining,"
+                           " building its dags and mining them",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    std::vector<std::string> partitioningValues;
+    partitioningValues.push_back("NONE");
+    partitioningValues.push_back("INITIAL_OUTLINK");
+    TCLAP::ValuesConstraint<std::string> partitioningConstraint(partitioningValues);
+    TCLAP::ValueArg<std::string> partitioningArg(
+        "p",
+        "partitioning-scheme",
+        "How the adjacency lists are partitioned in clusters, as in generateComplexes (the hashing schemes aren't"
+            " offered, as they aren't reproducible between runs). Defaults to INITIAL_OUTLINK.",
+        false,
+        "INITIAL_OUTLINK",
+        &partitioningConstraint,
+        cmd);
+    TCLAP::ValueArg<unsigned int> repetitionsArg(
+        "n",
+        "repetitions",
+        "Number of times that each order is run; the reported times are averages. Defaults to 3.",
+        false,
+        3,
+        "REPETITIONS",
+        cmd);
+
+    TCLAP::UnlabeledValueArg<std::string> graphFileNameArg(
+        "GRAPH_FILE",
+        "Path to an input text file with a graph, in the format accepted by the Graph constructor.",
+        true,
+        "",
+        "GRAPH_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (graphFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", graphFileNameArg.longID());
+    if (repetitionsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one repetition is required", repetitionsArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.graphFileName = graphFileNameArg.getValue();
+    args.repetitions   =   repetitionsArg.getValue();
+
+    args.partitioning = 0;
+    if (partitioningArg.getValue() == "INITIAL_OUTLINK")
+        args.partitioning = 1;
+
+    return args;
+}
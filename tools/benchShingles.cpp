@@ -0,0 +1,226 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <exception>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdlib>      // std::rand, std::srand
+
+#include <chrono>       // for timing
+
+#include <boost/functional/hash.hpp>
+#include <tclap/CmdLine.h>
+
+#include <odsg/Graph.hpp>
+#include <odsg/Shingles.hpp>
+#include <odsg/utils/strings.hpp>
+
+using namespace odsg;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input files
+    std::string graphFileName;
+
+    // Options related to the benchmark itself
+    unsigned int shingleSize;
+    unsigned int signaturesCount;
+    unsigned long long seed;
+    unsigned int repetitions;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * The signature as it was computed originally by Shingles::sign(): shingles of size 1 and a single signature, with
+ * each outlink turned into a string and hashed by boost::hash.
+ */
+unsigned long long
+legacySignatures(const Graph& graph, unsigned int A, unsigned int B) {
+    static const unsigned long bigPrime = 0x7FFFFFFF;
+    boost::hash<std::string> stringHash;
+    unsigned long long checksum = 0;
+
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        unsigned int minShingleHash = bigPrime;
+        for (Graph::Outlinks::const_iterator vxit = it->second.begin(); vxit != it->second.end(); ++vxit) {
+            std::size_t shingleID = stringHash(strings::to_str(*vxit));
+            unsigned int shingleHash = (((unsigned long) A * (unsigned long) shingleID) + B) % bigPrime;
+            if (minShingleHash > shingleHash)
+                minShingleHash = shingleHash;
+        }
+        checksum += minShingleHash;
+    }
+    return checksum;
+}
+
+
+unsigned long long
+engineSignatures(const Graph& graph, const Shingles& shingles, std::vector<Shingles::Signature>& out) {
+    unsigned long long checksum = 0;
+
+    out.resize(graph.listsCount() * shingles.signaturesCount());
+    std::size_t offset = 0;
+    for (Graph::const_iterator it = graph.begin(); it != graph.end(); ++it) {
+        shingles.sign(it->second, &out[offset]);
+        for (unsigned int k = 0; k < shingles.signaturesCount(); ++k)
+            checksum += out[offset + k];
+        offset += shingles.signaturesCount();
+    }
+    return checksum;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    Graph graph;
+    try {
+        graph = Graph(args.graphFileName);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    graph.rebuildForMining(Graph::VertexComparer());
+
+    std::cout << graph.listsCount() << " adjacency lists, " << graph.arcsCount() << " arcs, shingles of size "
+              << args.shingleSize << ", " << args.signaturesCount << " signatures by list\n";
+
+    std::srand(static_cast<unsigned int>(args.seed));
+    const unsigned int A = (std::rand() % 0x7FFFFFFF) + 1;
+    const unsigned int B = (std::rand() % 0x7FFFFFFF) + 1;
+
+    double legacyTime = 0.0, engineTime = 0.0;
+    std::vector<Shingles::Signature> first, again;
+    const Shingles shingles(args.shingleSize, args.signaturesCount, args.seed);
+
+    for (unsigned int rep = 0; rep < args.repetitions; ++rep) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long long legacyChecksum = legacySignatures(graph, A, B);
+        legacyTime += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        unsigned long long engineChecksum = engineSignatures(graph, shingles, rep == 0 ? first : again);
+        engineTime += secondsSince(start);
+
+        std::cerr << "\trepetition " << rep + 1 << ": checksums " << legacyChecksum << " / " << engineChecksum << '\n';
+    }
+
+    // The signatures must be bit-identical between repetitions, and for a fresh engine with the same seed
+    std::vector<Shingles::Signature> fresh;
+    engineSignatures(graph, Shingles(args.shingleSize, args.signaturesCount, args.seed), fresh);
+    bool identical = (fresh == first) && (args.repetitions < 2 || again == first);
+
+    legacyTime /= args.repetitions;
+    engineTime /= args.repetitions;
+    std::cout << "legacy (strings, 1 signature): " << legacyTime << " s, " << graph.arcsCount() / legacyTime
+              << " outlinks/s\n"
+              << "integer engine:                " << engineTime << " s, " << graph.arcsCount() / engineTime
+              << " outlinks/s\n"
+              << "speedup:                       " << legacyTime / engineTime << "x\n"
+              << "deterministic:                 " << (identical ? "yes" : "NO") << '\n';
+
+    return identical ? 0 : 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Benchmark the throughput of the shingles signatures used to partition graphs",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    TCLAP::ValueArg<unsigned int> shingleSizeArg(
+        "s",
+        "shingle-size",
+        "Number of consecutive outlinks by shingle. Defaults to 1.",
+        false,
+        1,
+        "SHINGLE_SIZE",
+        cmd);
+    TCLAP::ValueArg<unsigned int> signaturesCountArg(
+        "c",
+        "signatures",
+        "Number of signatures computed by adjacency list. Defaults to 1.",
+        false,
+        1,
+        "SIGNATURES",
+        cmd);
+    TCLAP::ValueArg<unsigned long long> seedArg(
+        "",
+        "seed",
+        "Seed for the hash functions of both implementations.",
+        false,
+        1,
+        "SEED",
+        cmd);
+    TCLAP::ValueArg<unsigned int> repetitionsArg(
+        "n",
+        "repetitions",
+        "Number of times that each implementation is run; the reported times are averages. Defaults to 3.",
+        false,
+        3,
+        "REPETITIONS",
+        cmd);
+
+    TCLAP::UnlabeledValueArg<std::string> graphFileNameArg(
+        "GRAPH_FILE",
+        "Path to an input text file with a graph, in the format accepted by the Graph constructor.",
+        true,
+        "",
+        "GRAPH_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (graphFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", graphFileNameArg.longID());
+    if (shingleSizeArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("Shingles must have at least one outlink", shingleSizeArg.longID());
+    if (signaturesCountArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one signature is required", signaturesCountArg.longID());
+    if (repetitionsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one repetition is required", repetitionsArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.graphFileName   =   graphFileNameArg.getValue();
+    args.shingleSize     =     shingleSizeArg.getValue();
+    args.signaturesCount = signaturesCountArg.getValue();
+    args.seed            =            seedArg.getValue();
+    args.repetitions     =     repetitionsArg.getValue();
+
+    return args;
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <functional>                      // std::function
 
 #include <ctime>                           // for timing
 
@@ -14,13 +15,18 @@
 
 #include <odsg/utils/algorithms.hpp>
 #include <odsg/DagForest.hpp>
+#include <odsg/GraphCluster.hpp>
+#include <odsg/GraphPartitioner.hpp>
+#include <odsg/MultiSeedMiner.hpp>
 #include <odsg/DenseSubGraphsMaximalSet.hpp>
 #include <odsg/Graph.hpp>
 #include <odsg/Vertex.hpp>
 #include <odsg/VertexSet.hpp>
+#include <odsg/VertexRenumbering.hpp>
 
 #include <typedefs.hpp>
 #include <readFile.hpp>
+#include <clusterGraphs.hpp>
 #include <metrics.hpp>
 #include <printing.hpp>
 #include <min.hpp>
@@ -34,9 +40,30 @@ struct CmdLineArgs {    // The definition of processCmdLine() constains descript
     std::string datasetMappingFileName;
     std::string datasetFileName;
 
+    // Options related to the clustering of the dataset by MinHash
+    unsigned int minhashBands;
+    unsigned int minhashRowsPerBand;
+    unsigned long long minhashSeed;
+    bool minhashOnePermutation;
+    bool minhashWeighted;
+    unsigned int minhashSignatureBits;
+    double minhashMinSimilarity;
+
+    unsigned int threads;
+
     // Options related to the way that complexes are generated
     int partitioning;
+    unsigned int minClusterArcs;
+    unsigned int maxClusterArcs;
+    bool contiguousClusters;
+    unsigned int maxBucketLists;
+    unsigned int maxBucketArcs;
+    unsigned int shingleSize;
+    unsigned int shinglesCount;
+    unsigned int partitioningRuns;
+    unsigned long long partitioningSeed;
     std::string outlinksSorting;
+    std::string renumbering;
     bool cliquesOnly;
 
     bool weightedDataset;
@@ -45,6 +72,9 @@ struct CmdLineArgs {    // The definition of processCmdLine() constains descript
     unsigned int objective;     // Not exposed, dependent of weightDensityMetric
 
     std::string extendedLogFileName;
+    std::string clustersDumpFileName;
+    std::string saveSnapshotsPrefix;
+    std::string loadSnapshotsPrefix;
 
     // Options related to the way that generated complexes are treated
     unsigned int minComplexSize;
@@ -194,6 +224,7 @@ partitioningMsg(int partitioning) {
         case 0:     return "No graph partitioning";
         case 1:     return "Graph partitioning according to common initial outlink";
         case 2:     return "Graph partitioning according to common signature via 'shingles'";
+        case 3:     return "Graph partitioning according to shared two-level 'shingles'";
         default:    return "Graph partitioning according to... Uh?";
     }
 }
@@ -206,7 +237,7 @@ int
 main(int argc, char* argv[]) {
 
     clock_t start, finish, start_min,finish_min,start_wgraph, finish_wgraph, start_dag, finish_dag;
-    double total_time, min_time, minw_time, wgraph_con_time, wgraph_min_time, dag_total_time;
+    double total_time, min_time, wgraph_con_time, wgraph_min_time, dag_total_time;
     start = clock();
 
 
@@ -230,80 +261,115 @@ main(int argc, char* argv[]) {
         std::cerr << "error: can not open file for extended log";
         return 1;
     }
-    //Vector que contiene los clusters obtenidos con el minhash
-    std::cout<<"Preparando Minhash para encontrar clusters\n";
-    start_min = clock();
-    std::vector<std::vector<int>> v1 = minhash::min(args.datasetFileName);
-    finish_min = clock();
-    min_time = double(finish_min - start_min) / CLOCKS_PER_SEC;
-    std::cout<<"Se han obtenido "<<v1.size()<<" clusters en "<<min_time<<'\n';
-    //Grafo con la listas de cada nodo para poder mapear los nodos de un cluster con todas sus aristas
-    std::vector<std::vector<long long int>> gadj = minhash::graph;
-    std::cout<<"Preparando archivo para construir WGraphs de los clusters obtenidos\n";
     //Vector de WGraph, uno por cada cluster
     std::vector<WGraph> datasetWGraph;
     //Vector de punteros de WGraph para poder armar los dagForest
     std::vector<Graph*> datasetGraph_ptr;
-    //Mapeo de cluster a grafo en un archivo que se crea
-    //Imprime un cluster con sus nodos y listas, luego agrega un # para indicar el final del cluster
-    std::ofstream myfile;
-    myfile.open("clusters.txt");
-    start_min = clock();
-    for(int i = 0; i < v1.size(); ++i){
-        int flag = 0;
-        for(int j = 0; j < v1[i].size(); ++j){
-            int node = v1[i][j];
-            int flag_sloop = 0;
-            if(gadj[node-1].size() < 3) flag = 1; //Esto es para considerar el minimo tamanio especificado en el algoritmo original
-            for(int k = 0; k < gadj[node-1].size(); ++k){
-                if(node == gadj[node-1][k])flag_sloop =1; //Si el nodo tenia un self loop, no lo agregamos
-                if(k < gadj[node-1].size())myfile<<node<<' '<<gadj[node-1][k]<<' '<<1.0<<'\n';
-            }
-            if(!flag_sloop)myfile<<node<<' '<<node<<' '<<1.0<<'\n';//Si el nodo no tenia self loop, se lo agregamos.
-        }if(flag==0)myfile<<"#\n";
-    }
-    myfile.close();
-    gadj.clear();
-    finish_min = clock();
-    minw_time = double(finish_min - start_min) / CLOCKS_PER_SEC;
-    std::cout<<"Se creó el archivo que contiene los nodos en el formato correcto en "<<minw_time<<'\n';
     // This mapping will apply to all the proteins seen from now
     ProteinsMap proteinMapping;
-
-
-    // Get the (optional) custom mapping, previous to the dataset parsing
-   if (!args.datasetMappingFileName.empty()) {
-        std::cerr << "\nReading dataset mapping file... " << std::flush;
+    // The optional renumbering of the vertexes, by graph; the mined dense subgraphs are mapped back to the original ids
+    std::vector<VertexRenumbering> renumberings;
+    if (!args.loadSnapshotsPrefix.empty()) {
+        // The graphs were saved already rebuilt for mining, with the mapping of their proteins
+        std::cerr << "\nLoading the graphs of the clusters from snapshots... " << std::flush;
+        start_wgraph = clock();
         try {
-            proteinMapping = readDatasetMappingFromFile(args.datasetMappingFileName);
+            datasetWGraph = readClustersSnapshots(args.loadSnapshotsPrefix, proteinMapping);
         } catch (std::exception& e) {
             std::cerr << "ERROR\n" << e.what() << std::endl;
             return 1;
         }
         std::cerr << "OK\n"
-                  << '\t' << proteinMapping.size() << " different proteins\n"
+                  << '\t' << datasetWGraph.size() << " graphs\n"
                   ;
-    }
-    std::cout<<"Creando WGraphs\n";
-    // Aqui modifique la funcion readDatasetFromFileWW ubicada en dapg_complexes/src/readFile.cpp
-    start_wgraph = clock();
-    datasetWGraph = readDatasetFromFileWW("clusters.txt", args.weightedDataset, proteinMapping);
-    finish_wgraph = clock();
-    wgraph_con_time = double(finish_wgraph - start_wgraph) / CLOCKS_PER_SEC;
-    //Introducimos los WGraph al vector de punteros
-    std::cout<<"WGraphs creados en "<<wgraph_con_time<<", preparandolos para ser mineables\n";
-    start_wgraph = clock();
-    for(int i = 0; i < datasetWGraph.size(); ++i){
-        datasetGraph_ptr.push_back(&datasetWGraph[i]);
-    }
-    //Preparamos los grafos para ser minados
-    if(args.outlinksSorting == "ID"){
-        for(int i = 0; i < datasetGraph_ptr.size();++i){
-            datasetGraph_ptr[i]->rebuildForMining(Graph::VertexComparer());
+        for (std::size_t i = 0; i < datasetWGraph.size(); ++i) {
+            datasetGraph_ptr.push_back(&datasetWGraph[i]);
         }
-    }else{
-        for(int i = 0; i < datasetGraph_ptr.size();++i){
-            datasetGraph_ptr[i]->rebuildForMining();
+    } else {
+        //Vector que contiene los clusters obtenidos con el minhash
+        std::cout<<"Preparando Minhash para encontrar clusters\n";
+        minhash::Parameters minhashParams;
+        minhashParams.bands       = args.minhashBands;
+        minhashParams.rowsPerBand = args.minhashRowsPerBand;
+        minhashParams.seed        = args.minhashSeed;
+        minhashParams.onePermutation = args.minhashOnePermutation;
+        minhashParams.weighted    = args.minhashWeighted;
+        minhashParams.signatureBits = args.minhashSignatureBits;
+        minhashParams.minSimilarity = args.minhashMinSimilarity;
+        minhashParams.threads     = args.threads;
+        std::cerr << "MinHash banding with " << minhashParams.bands << " bands of " << minhashParams.rowsPerBand
+                  << " signatures" << (minhashParams.onePermutation ? ", by one permutation hashing" : "")
+                  << (minhashParams.weighted ? ", by weighted MinHash" : "")
+                  << (minhashParams.bBit() ? ", truncated to " + std::to_string(minhashParams.signatureBits) + " bits"
+                                           : "")
+                  << "\n";
+        start_min = clock();
+        minhash::Result minhashResult;
+        try {
+            minhashResult = minhash::min(args.datasetFileName, minhashParams);
+        } catch (std::exception& e) {
+            std::cerr << "ERROR\n" << e.what() << std::endl;
+            return 1;
+        }
+        finish_min = clock();
+        min_time = double(finish_min - start_min) / CLOCKS_PER_SEC;
+        const std::vector<std::vector<int>>& v1 = minhashResult.clusters;
+        std::cout<<"Se han obtenido "<<v1.size()<<" clusters en "<<min_time<<'\n';
+
+
+        // Get the (optional) custom mapping, previous to the dataset parsing
+       if (!args.datasetMappingFileName.empty()) {
+            std::cerr << "\nReading dataset mapping file... " << std::flush;
+            try {
+                proteinMapping = readDatasetMappingFromFile(args.datasetMappingFileName);
+            } catch (std::exception& e) {
+                std::cerr << "ERROR\n" << e.what() << std::endl;
+                return 1;
+            }
+            std::cerr << "OK\n"
+                      << '\t' << proteinMapping.size() << " different proteins\n"
+                      ;
+        }
+        std::cout<<"Creando WGraphs\n";
+        //Los WGraph se construyen directamente desde los clusters y las listas de adyacencia, sin pasar por un archivo
+        start_wgraph = clock();
+        std::ofstream clustersDumpFile;
+        if (!args.clustersDumpFileName.empty()) {
+            clustersDumpFile.open(args.clustersDumpFileName.c_str());
+            if (!clustersDumpFile) {
+                std::cerr << "error: can not open file for the clusters dump";
+                return 1;
+            }
+        }
+        datasetWGraph = buildClustersWGraphs(v1, minhashResult.graph, proteinMapping,
+                                             clustersDumpFile.is_open() ? &clustersDumpFile : NULL);
+        clustersDumpFile.close();
+        minhashResult = minhash::Result();     // Release the graph of the dataset, it's not needed anymore
+        finish_wgraph = clock();
+        wgraph_con_time = double(finish_wgraph - start_wgraph) / CLOCKS_PER_SEC;
+        //Introducimos los WGraph al vector de punteros
+        std::cout<<"WGraphs creados en "<<wgraph_con_time<<", preparandolos para ser mineables\n";
+        start_wgraph = clock();
+        if (args.renumbering != "NONE") {
+            renumberings.reserve(datasetWGraph.size());
+            for (std::size_t i = 0; i < datasetWGraph.size(); ++i) {
+                renumberings.push_back(VertexRenumbering(datasetWGraph[i],
+                                                         VertexRenumbering::toOrder(args.renumbering)));
+                datasetWGraph[i] = renumberings.back().apply(datasetWGraph[i]);
+            }
+        }
+        for(int i = 0; i < datasetWGraph.size(); ++i){
+            datasetGraph_ptr.push_back(&datasetWGraph[i]);
+        }
+        //Preparamos los grafos para ser minados
+        if(args.outlinksSorting == "ID"){
+            for(int i = 0; i < datasetGraph_ptr.size();++i){
+                datasetGraph_ptr[i]->rebuildForMining(Graph::VertexComparer(), args.threads);
+            }
+        }else{
+            for(int i = 0; i < datasetGraph_ptr.size();++i){
+                datasetGraph_ptr[i]->rebuildForMining(args.threads);
+            }
         }
     }
     for(int i = 0; i < datasetGraph_ptr.size(); ++i){
@@ -315,6 +381,16 @@ main(int argc, char* argv[]) {
     finish_wgraph = clock();
     wgraph_min_time = double(finish_wgraph - start_wgraph) / CLOCKS_PER_SEC;
     std::cout<<"WGraphs listos en "<<wgraph_min_time<<'\n';
+    if (!args.saveSnapshotsPrefix.empty()) {
+        std::cerr << "\nSaving the graphs of the clusters as snapshots... " << std::flush;
+        try {
+            writeClustersSnapshots(args.saveSnapshotsPrefix, datasetWGraph, proteinMapping);
+        } catch (std::exception& e) {
+            std::cerr << "ERROR\n" << e.what() << std::endl;
+            return 1;
+        }
+        std::cerr << "OK\n";
+    }
     //Definimos contadores y vectores para guardar cantidad y elementos.
     long long int cliques = 0; // Contador de cliques
     long long int biclique_r = 0; // Contador de Bicliques Rigurosos (Interseccion de S y C vacia)
@@ -325,37 +401,69 @@ main(int argc, char* argv[]) {
 
     unsigned int totalDagsBuilt = 0;
     int cont = 0;
+    // With several partitioning runs, each one gets its own seed, derived from a single one so it can be reproduced
+    std::vector<unsigned long long> partitioningSeeds;
+    if (args.partitioningRuns > 1) {
+        unsigned long long seed = args.partitioningSeed != 0 ? args.partitioningSeed
+                                                             : static_cast<unsigned long long>(std::time(NULL));
+        partitioningSeeds = MultiSeedMiner::seeds(seed, args.partitioningRuns);
+        std::cerr << args.partitioningRuns << " partitioning runs by cluster, from the seed " << seed << "\n";
+    }
     std::cout<<"Generating DagForests"<<std::endl;
     start_dag = clock();
     for(int i = 0; i < datasetGraph_ptr.size();++i){
-        const DagForest myForest(*datasetGraph_ptr[i],args.partitioning,1);
-        //std::cout<<"DagForest for cluster "<<i+1<<" ready"<<std::endl;
-        for (DagForest::const_iterator dit = myForest.begin(); dit != myForest.end(); ++dit) {
-            const Dag& dag = **dit;
-            const DenseSubGraphsMaximalSet dagDSGs = dag.getDenseSubGraphs(0,
-                                                                        args.objective,
-                                                                        args.cliquesOnly,
-                                                                            1);
+        typedef std::function<void(const DenseSubGraphsMaximalSet&)> DenseSubGraphsVisitor;
+        const DenseSubGraphsVisitor classify = [&](const DenseSubGraphsMaximalSet& dagDSGs) {
             if (dagDSGs.empty())
-                continue;
+                return;
             // Indica el numero de dense sub graphs por cluster
-            for (std::vector<DenseSubGraph>::const_iterator it = dagDSGs.begin(); it != dagDSGs.end(); ++it) {
-                if(it->biClique()){
-                    if(vector_bicliques.size() <= 10)vector_bicliques.push_back(*it);
+            for (std::vector<DenseSubGraph>::const_iterator dsgit = dagDSGs.begin(); dsgit != dagDSGs.end(); ++dsgit) {
+                const DenseSubGraph dsg = renumberings.empty() ? *dsgit : renumberings[i].original(*dsgit);
+                if(dsg.biClique()){
+                    if(vector_bicliques.size() <= 10)vector_bicliques.push_back(dsg);
                     biclique_r++;
                 }
-                if(it->clique()){
-                    if(vector_cliques.size()<=10)vector_cliques.push_back(*it);
+                if(dsg.clique()){
+                    if(vector_cliques.size()<=10)vector_cliques.push_back(dsg);
                     cliques++;
                 }
-                if(!it->biClique() && !it->clique()){
-                    if(vector_bicliques_no_riguroso.size() <= 10)vector_bicliques_no_riguroso.push_back(*it);
+                if(!dsg.biClique() && !dsg.clique()){
+                    if(vector_bicliques_no_riguroso.size() <= 10)vector_bicliques_no_riguroso.push_back(dsg);
                     biclique_nr++;
                 }
                 cont++;
             }
 
             totalDagsBuilt += dagDSGs.size();
+        };
+        // Each dag is mined and freed before the next one is built, so only the biggest one is held in memory
+        const DagForest::DagVisitor mine = [&](const Dag& dag) {
+            classify(dag.getDenseSubGraphs(0, args.objective, args.cliquesOnly, 1));
+        };
+
+        if (!partitioningSeeds.empty()) {
+            // The graph was rebuilt for mining once: all the runs share it
+            const MultiSeedMiner miner(*datasetGraph_ptr[i], args.partitioning, args.minClusterArcs,
+                                       args.maxClusterArcs, args.contiguousClusters, args.maxBucketLists,
+                                       args.maxBucketArcs, args.shingleSize, args.shinglesCount);
+            classify(miner.mine(partitioningSeeds, args.objective, args.cliquesOnly, 1, args.threads));
+        } else if (args.partitioning == 2 && (args.maxBucketLists > 0 || args.maxBucketArcs > 0)
+            && !datasetGraph_ptr[i]->empty()) {
+            GraphPartitionerBySignature partitioner(datasetGraph_ptr[i], args.maxBucketLists, args.maxBucketArcs, 0,
+                                                    args.threads);
+            DagForest::stream(*datasetGraph_ptr[i], partitioner, mine, args.minClusterArcs, false,
+                              args.maxClusterArcs, args.contiguousClusters, args.threads);
+            std::ostream& report = extendedLogging ? extendedLogFile : std::cerr;
+            report << "Cluster " << i + 1 << ": ";
+            partitioner.printBucketsReport(report);
+        } else if (args.partitioning == 3 && !datasetGraph_ptr[i]->empty()) {
+            GraphPartitionerByTwoLevelShingles partitioner(datasetGraph_ptr[i], args.shingleSize, args.shinglesCount,
+                                                           0, args.threads);
+            DagForest::stream(*datasetGraph_ptr[i], partitioner, mine, args.minClusterArcs, false,
+                              args.maxClusterArcs, args.contiguousClusters, args.threads);
+        } else {
+            DagForest::stream(*datasetGraph_ptr[i], mine, args.partitioning, args.minClusterArcs, false,
+                              args.maxClusterArcs, args.contiguousClusters, args.threads);
         }
     }
     finish_dag = clock();
@@ -461,6 +569,14 @@ processCmdLine(int argc, char* argv[]) {
         "<internal> Limit the mining to dense subgraphs with maximal centers sets between themselves, i.e. cliques.",
         cmd,
         false);
+    TCLAP::SwitchArg contiguousClustersArg(
+        "",
+        "contiguous-clusters",
+        "<internal> Copy the adjacency lists to contiguous arrays, cluster by cluster, after the partitioning (see -p"
+            " option), so the dags are built by linear scans. The clusters are copied by batches of up to the arcs"
+            " of the biggest one, so the copy never takes more memory than the biggest cluster.",
+        cmd,
+        false);
 
     // Value args defines a flag and a type of value that it expects
     TCLAP::ValueArg<std::string> datasetMappingFileNameArg(
@@ -481,6 +597,37 @@ processCmdLine(int argc, char* argv[]) {
         "",
         "EXTENDED_LOG_FILE",
         cmd);
+    TCLAP::ValueArg<std::string> clustersDumpFileNameArg(
+        "",
+        "dump-clusters",
+        "<internal> Path to a output text file where the interactions of each MinHash cluster are written, for"
+            " debugging; clusters are separated by lines with a single '#'.",
+        false,
+        "",
+        "CLUSTERS_DUMP_FILE",
+        cmd);
+    TCLAP::ValueArg<std::string> saveSnapshotsPrefixArg(
+        "",
+        "save-snapshots",
+        "<internal> Save the graphs of the MinHash clusters, once rebuilt for mining, as binary snapshots (one file"
+            " by graph, named PREFIX.<i>.snap, with the weights) and the mapping of their proteins (PREFIX.mapping),"
+            " so later runs can mine them again without clustering the dataset (see --load-snapshots option)."
+            " Not compatible with the --renumbering option.",
+        false,
+        "",
+        "PREFIX",
+        cmd);
+    TCLAP::ValueArg<std::string> loadSnapshotsPrefixArg(
+        "",
+        "load-snapshots",
+        "<internal> Mine the graphs saved by a previous run with the --save-snapshots option, instead of clustering"
+            " a dataset: no DATASET_FILE is read, and the graphs keep the mapping, the weights and the sorting of the"
+            " adjacency lists of that run (so the -m, -r and MinHash options are ignored)."
+            " Not compatible with the --renumbering option.",
+        false,
+        "",
+        "PREFIX",
+        cmd);
     TCLAP::ValueArg<unsigned int> minComplexSizeArg(
         "s",
         "min-size",
@@ -491,6 +638,81 @@ processCmdLine(int argc, char* argv[]) {
         "MINIMUM_COMPLEX_SIZE",
         cmd);
 
+    TCLAP::ValueArg<unsigned int> threadsArg(
+        "t",
+        "threads",
+        "Number of threads used to parse and sign the dataset, and to run the partitioning runs (see"
+            " --partitioning-runs option); the result doesn't depend on it. Defaults to 1.",
+        false,
+        1,
+        "THREADS",
+        cmd);
+    TCLAP::SwitchArg minhashOnePermutationArg(
+        "",
+        "one-permutation",
+        "Compute all the MinHash signatures of each adjacency list with a single hash by shingle (one permutation"
+            " hashing, with densification of the empty bins), instead of one hash by shingle and signature."
+            " It makes cheap to use many bands (see -b and --rows-per-band options).",
+        cmd,
+        false);
+    TCLAP::SwitchArg minhashWeightedArg(
+        "",
+        "weighted-minhash",
+        "Cluster the dataset by weighted MinHash (consistent weighted sampling), so weak interactions hardly ever"
+            " put two adjacency lists in the same cluster. Each line of the dataset must alternate ids and the"
+            " weights of their interactions, that are carried into the graphs of the clusters; so it requires USYM"
+            " graphs (see -g option). Not compatible with the --one-permutation option.",
+        cmd,
+        false);
+    TCLAP::ValueArg<unsigned int> minhashBandsArg(
+        "b",
+        "bands",
+        "Number of LSH bands used to cluster the dataset by MinHash; each band is hashed in its own table, and two"
+            " adjacency lists share a cluster if they match in all the signatures of some band."
+            " More bands give more recall. Defaults to 2.",
+        false,
+        2,
+        "BANDS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> minhashRowsPerBandArg(
+        "",
+        "rows-per-band",
+        "Number of MinHash signatures in each LSH band (see -b option). More signatures by band give smaller and"
+            " tighter clusters. Defaults to 1.",
+        false,
+        1,
+        "ROWS_PER_BAND",
+        cmd);
+    TCLAP::ValueArg<unsigned int> minhashSignatureBitsArg(
+        "",
+        "signature-bits",
+        "Number of bits kept of each MinHash signature: 8, 16 or 32. With 8 or 16, the signatures of all the"
+            " adjacency lists are kept in a compact matrix, and banded only at the end; it saves memory with many"
+            " signatures (see -b and --rows-per-band options), at the cost of some chance collisions; 8 bits require"
+            " more than one signature by band. Defaults to 32.",
+        false,
+        32,
+        "BITS",
+        cmd);
+    TCLAP::ValueArg<double> minhashMinSimilarityArg(
+        "",
+        "min-similarity",
+        "<internal> With less than 32 bits by signature, the adjacency lists of a cluster must be linked by pairs"
+            " with a similarity above this value, estimated from all their signatures and corrected for the chance"
+            " collisions of truncated signatures. Defaults to 0.",
+        false,
+        0.0,
+        "SIMILARITY",
+        cmd);
+    TCLAP::ValueArg<unsigned long long> minhashSeedArg(
+        "",
+        "minhash-seed",
+        "<internal> Seed for the hash functions of the MinHash signatures; the same seed gives the same clusters.",
+        false,
+        minhash::DEFAULT_SEED,
+        "SEED",
+        cmd);
+
     std::vector<std::string> outlinksSortingValues;
     outlinksSortingValues.push_back("ID");
     outlinksSortingValues.push_back("FREQUENCY");
@@ -508,6 +730,25 @@ processCmdLine(int argc, char* argv[]) {
         &outlinksSortingConstraint,
         cmd);
 
+    std::vector<std::string> renumberingValues;
+    renumberingValues.push_back("NONE");
+    renumberingValues.push_back("DEGREE");
+    renumberingValues.push_back("CUTHILL_MCKEE");
+    renumberingValues.push_back("COMMUNITY");
+    TCLAP::ValuesConstraint<std::string> renumberingConstraint(renumberingValues);
+    TCLAP::ValueArg<std::string> renumberingArg(
+        "",
+        "renumbering",
+        "<internal> Renumber the proteins of each cluster for locality before mining it (the predicted complexes"
+            " are still reported with the original proteins):"
+            " DEGREE by decreasing degree;"
+            " CUTHILL_MCKEE by breadth-first search from the proteins of lowest degree;"
+            " COMMUNITY by communities found by label propagation. Defaults to NONE.",
+        false,
+        "NONE",
+        &renumberingConstraint,
+        cmd);
+
     std::vector<std::string> graphTypeValues;
     graphTypeValues.push_back("UNONE");
     graphTypeValues.push_back("USYM");
@@ -517,7 +758,8 @@ processCmdLine(int argc, char* argv[]) {
         "graph-types",
         "Select how the weights for the protein interactions, present the dataset given as input file, are treated."
             " UNONE will ignore the weights (if present);"
-            " USYM will include the weights (if missing, they are assumed as 1.0)."
+            " USYM will include the weights (if missing, they are assumed as 1.0); they are only read from the dataset"
+            " with the --weighted-minhash option."
             " Defaults to UNONE.",
         false,
         "UNONE",
@@ -550,6 +792,7 @@ processCmdLine(int argc, char* argv[]) {
     partitioningValues.push_back("NONE");
     partitioningValues.push_back("HASHING");
     partitioningValues.push_back("INITIAL_OUTLINK");
+    partitioningValues.push_back("TWO_LEVEL_HASHING");
     TCLAP::ValuesConstraint<std::string> partitioningConstraint(partitioningValues);
     TCLAP::ValueArg<std::string> partitioningArg(
         "p",
@@ -558,12 +801,91 @@ processCmdLine(int argc, char* argv[]) {
             " from which each prefix dags is built:"
             " NONE prevents all partitioning (same as the -u option);"
             " INITIAL_OUTLINK groups adjacency lists sharing the same initial outlink after sorting (see -r option);"
-            " HASHING groups adjacency lists with the same 'shingling' signature. Defaults to INITIAL_OUTLINK;"
+            " HASHING groups adjacency lists with the same 'shingling' signature;"
+            " TWO_LEVEL_HASHING groups adjacency lists connected by shared second-level 'shingles' (shingles of"
+            " their shingles). Defaults to INITIAL_OUTLINK;"
             " it's ignored if the -u option is used.",
         false,
         "INITIAL_OUTLINK",
         &partitioningConstraint,
         cmd);
+    TCLAP::ValueArg<unsigned int> minClusterArcsArg(
+        "",
+        "min-cluster-arcs",
+        "<internal> Merge the clusters of the partitioning (see -p option) until having at least this number of arcs,"
+            " so tiny clusters don't pay the overhead of a dag each; with the --max-cluster-arcs option, the smaller"
+            " clusters are packed together up to that bound instead. Defaults to 1.",
+        false,
+        1,
+        "ARCS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> maxClusterArcsArg(
+        "",
+        "max-cluster-arcs",
+        "<internal> Bound the cost of mining each cluster of the partitioning (see -p option) to about this number of"
+            " arcs: bigger clusters are split, re-hashing their adjacency lists, and the smaller ones are packed"
+            " together. Defaults to 0, no bound.",
+        false,
+        0,
+        "ARCS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> maxBucketListsArg(
+        "",
+        "max-bucket-lists",
+        "<internal> With HASHING partitioning (see -p option), re-sign the adjacency lists of the buckets with more"
+            " than this number of lists, splitting them, and report the sizes of the buckets before and after (in the"
+            " extended log, if any; see -e option). The limit applies to each of several partitioning runs too, but"
+            " the report is given only for a single run."
+            " Defaults to 0, no limit.",
+        false,
+        0,
+        "LISTS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> maxBucketArcsArg(
+        "",
+        "max-bucket-arcs",
+        "<internal> Like --max-bucket-lists, but limiting the number of arcs by bucket. Defaults to 0, no limit.",
+        false,
+        0,
+        "ARCS",
+        cmd);
+    TCLAP::ValueArg<unsigned int> shingleSizeArg(
+        "",
+        "shingle-size",
+        "<internal> With TWO_LEVEL_HASHING partitioning (see -p option), number of consecutive outlinks (first level)"
+            " or first-level shingles (second level) hashed together in each shingle. Defaults to 2.",
+        false,
+        2,
+        "SIZE",
+        cmd);
+    TCLAP::ValueArg<unsigned int> shinglesCountArg(
+        "",
+        "shingles-count",
+        "<internal> With TWO_LEVEL_HASHING partitioning (see -p option), number of shingles computed by adjacency"
+            " list at each level; more shingles join more lists in each cluster. Defaults to 4.",
+        false,
+        4,
+        "COUNT",
+        cmd);
+    TCLAP::ValueArg<unsigned int> partitioningRunsArg(
+        "",
+        "partitioning-runs",
+        "<internal> With HASHING or TWO_LEVEL_HASHING partitioning (see -p option), partition, build the dags and mine"
+            " each cluster this number of times, each one with a different seed, keeping the maximal dense subgraphs"
+            " of all of them; dense subgraphs split by a partition can be found by another one. Defaults to 1.",
+        false,
+        1,
+        "RUNS",
+        cmd);
+    TCLAP::ValueArg<unsigned long long> partitioningSeedArg(
+        "",
+        "partitioning-seed",
+        "<internal> Seed from where the seeds of the partitioning runs are derived (see --partitioning-runs option);"
+            " the same seed gives the same runs. Defaults to 0, a seed from the current time.",
+        false,
+        0,
+        "SEED",
+        cmd);
 
     std::vector<std::string> similarityFilteringValues;
     similarityFilteringValues.push_back("NONE");
@@ -590,8 +912,9 @@ processCmdLine(int argc, char* argv[]) {
     //  - only one optional UnlabeledValueArg is possible; it must be the last listed.
     TCLAP::UnlabeledValueArg<std::string> datasetFileNameArg(
         "DATASET_FILE",             // A one word name for the argument, used only for identification
-        "Path to an input text file defining (probably weighted) protein-protein interactions: a PPI network.",
-        true,                       // Whether the argument is required on the command line
+        "Path to an input text file defining (probably weighted) protein-protein interactions: a PPI network."
+            " Required unless the graphs are loaded from snapshots (see --load-snapshots option).",
+        false,                      // Whether the argument is required on the command line
         "",                         // Default value of this argument; unused if the presence of the arg is required
         "DATASET_FILE",             // A short description of the value type, displayed in the USAGE output
         cmd);                       // The parser object to add this argument to
@@ -601,8 +924,51 @@ processCmdLine(int argc, char* argv[]) {
 
 
     // Extra validation checks
-    if (datasetFileNameArg.getValue().empty())
+    if (datasetFileNameArg.getValue().empty() && loadSnapshotsPrefixArg.getValue().empty())
         throw TCLAP::CmdLineParseException("Empty argument!", datasetFileNameArg.longID());
+    if (!loadSnapshotsPrefixArg.getValue().empty() && !datasetFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("The graphs loaded from snapshots replace the dataset",
+                                           loadSnapshotsPrefixArg.longID());
+    if (!loadSnapshotsPrefixArg.getValue().empty() && !saveSnapshotsPrefixArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Snapshots can't be loaded and saved in the same run",
+                                           saveSnapshotsPrefixArg.longID());
+    if ((!loadSnapshotsPrefixArg.getValue().empty() || !saveSnapshotsPrefixArg.getValue().empty())
+        && renumberingArg.getValue() != "NONE")
+        throw TCLAP::CmdLineParseException("Renumbered graphs can't be saved nor loaded as snapshots",
+                                           renumberingArg.longID());
+    if (threadsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one thread is required", threadsArg.longID());
+    if (minhashBandsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one band is required", minhashBandsArg.longID());
+    if (minhashRowsPerBandArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one signature by band is required",
+                                           minhashRowsPerBandArg.longID());
+    if (minhashSignatureBitsArg.getValue() != 8 && minhashSignatureBitsArg.getValue() != 16
+        && minhashSignatureBitsArg.getValue() != 32)
+        throw TCLAP::CmdLineParseException("Signatures must have 8, 16 or 32 bits", minhashSignatureBitsArg.longID());
+    if (minhashSignatureBitsArg.getValue() == 8 && minhashRowsPerBandArg.getValue() == 1)
+        throw TCLAP::CmdLineParseException("Signatures of 8 bits require more than one signature by band",
+                                           minhashSignatureBitsArg.longID());
+    if (shingleSizeArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("Shingles of at least one item are required", shingleSizeArg.longID());
+    if (shinglesCountArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one shingle by list is required", shinglesCountArg.longID());
+    if (partitioningRunsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one partitioning run is required", partitioningRunsArg.longID());
+    if (partitioningRunsArg.getValue() > 1
+        && (unifiedArg.getValue()
+            || (partitioningArg.getValue() != "HASHING" && partitioningArg.getValue() != "TWO_LEVEL_HASHING")))
+        throw TCLAP::CmdLineParseException("Several partitioning runs require a hashing partitioning scheme",
+                                           partitioningRunsArg.longID());
+    if (maxClusterArcsArg.getValue() > 0 && minClusterArcsArg.getValue() > maxClusterArcsArg.getValue())
+        throw TCLAP::CmdLineParseException("The minimum number of arcs of the clusters can't exceed the maximum",
+                                           minClusterArcsArg.longID());
+    if (minhashWeightedArg.getValue() && minhashOnePermutationArg.getValue())
+        throw TCLAP::CmdLineParseException("Weighted MinHash can't be done by one permutation hashing",
+                                           minhashWeightedArg.longID());
+    if (minhashWeightedArg.getValue() && graphTypeArg.getValue() != "USYM")
+        throw TCLAP::CmdLineParseException("Weighted MinHash requires USYM graphs, to keep the weights",
+                                           minhashWeightedArg.longID());
 
     //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
     CmdLineArgs args;
@@ -610,9 +976,30 @@ processCmdLine(int argc, char* argv[]) {
     args.datasetMappingFileName = datasetMappingFileNameArg.getValue();
     args.datasetFileName        =        datasetFileNameArg.getValue();
     args.outlinksSorting        =        outlinksSortingArg.getValue();
+    args.renumbering            =            renumberingArg.getValue();
     args.cliquesOnly            =            cliquesOnlyArg.getValue();
     args.extendedLogFileName    =    extendedLogFileNameArg.getValue();
+    args.clustersDumpFileName   =   clustersDumpFileNameArg.getValue();
+    args.saveSnapshotsPrefix    =    saveSnapshotsPrefixArg.getValue();
+    args.loadSnapshotsPrefix    =    loadSnapshotsPrefixArg.getValue();
     args.minComplexSize         =         minComplexSizeArg.getValue();
+    args.minhashBands           =           minhashBandsArg.getValue();
+    args.minhashRowsPerBand     =     minhashRowsPerBandArg.getValue();
+    args.minhashSeed            =            minhashSeedArg.getValue();
+    args.minhashOnePermutation  =  minhashOnePermutationArg.getValue();
+    args.minhashWeighted        =        minhashWeightedArg.getValue();
+    args.minhashSignatureBits   =   minhashSignatureBitsArg.getValue();
+    args.minhashMinSimilarity   =   minhashMinSimilarityArg.getValue();
+    args.threads                =                threadsArg.getValue();
+    args.minClusterArcs         =         minClusterArcsArg.getValue();
+    args.maxClusterArcs         =         maxClusterArcsArg.getValue();
+    args.contiguousClusters     =     contiguousClustersArg.getValue();
+    args.maxBucketLists         =         maxBucketListsArg.getValue();
+    args.maxBucketArcs          =          maxBucketArcsArg.getValue();
+    args.shingleSize            =            shingleSizeArg.getValue();
+    args.shinglesCount          =          shinglesCountArg.getValue();
+    args.partitioningRuns       =       partitioningRunsArg.getValue();
+    args.partitioningSeed       =       partitioningSeedArg.getValue();
 
     args.weightedDataset = graphTypeArg.getValue() == "USYM";
     args.weightDensityMetric = (graphTypeArg.getValue() == "USYM") ? weightDensityArg.getValue() : "";
@@ -640,6 +1027,8 @@ processCmdLine(int argc, char* argv[]) {
         args.partitioning = 1;
     else if (!unifiedArg.getValue() && partitioningArg.getValue() == "HASHING")
         args.partitioning = 2;
+    else if (!unifiedArg.getValue() && partitioningArg.getValue() == "TWO_LEVEL_HASHING")
+        args.partitioning = 3;
 
     return args;
 }
@@ -0,0 +1,175 @@
+#include <cassert>      // Support run-time assertions. They can be disabled defining the NDEBUG macro
+#include <exception>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <chrono>       // for timing
+
+#include <tclap/CmdLine.h>
+
+#include <odsg/Graph.hpp>
+#include <odsg/GraphSnapshot.hpp>
+
+using namespace odsg;
+
+
+struct CmdLineArgs {    // The definition of processCmdLine() constains descriptions for each option
+    // Input and output files
+    std::string graphFileName;
+    std::string snapshotFileName;
+
+    // Options related to the graph stored in the snapshot
+    std::string outlinksSorting;
+    unsigned int threads;
+};
+CmdLineArgs processCmdLine(int argc, char* argv[]);
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int
+main(int argc, char* argv[]) {
+
+    CmdLineArgs args;
+    try {
+        args = processCmdLine(argc, argv);
+    } catch (TCLAP::ArgException& e) {
+        std::cerr << "error: " << e.error() << " " << e.argId() << std::endl;
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Graph graph;
+    try {
+        graph = Graph(args.graphFileName, false, args.threads);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "text graph read in " << secondsSince(start) << " s\n";
+
+    start = std::chrono::steady_clock::now();
+    if (args.outlinksSorting == "ID") {
+        graph.rebuildForMining(Graph::VertexComparer(), args.threads);
+    } else if (args.outlinksSorting == "FREQUENCY") {
+        graph.rebuildForMiningExceptSorting();      // Required by VertexFrequencyComparer
+        graph.rebuildForMining(Graph::VertexFrequencyComparer(graph, args.threads), args.threads);
+    }
+    std::cerr << "graph rebuilt for mining in " << secondsSince(start) << " s\n";
+
+    start = std::chrono::steady_clock::now();
+    try {
+        GraphSnapshot::write(graph, args.snapshotFileName);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "snapshot written in " << secondsSince(start) << " s\n";
+
+    // Check the snapshot, and show how long it takes to get the graph back from it
+    start = std::chrono::steady_clock::now();
+    Graph reloaded;
+    try {
+        GraphSnapshot(args.snapshotFileName).load(reloaded);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR\n" << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "snapshot loaded in " << secondsSince(start) << " s\n";
+
+    std::cout << reloaded << '\n';
+    if (reloaded.listsCount() != graph.listsCount() || reloaded.arcsCount() != graph.arcsCount()) {
+        std::cerr << "error: the snapshot doesn't match the graph" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The next does use of the Templatized C++ Command Line Parser (TCLAP) library, in include/ directory.
+ *   http://tclap.sourceforge.net/manual.html
+ */
+CmdLineArgs
+processCmdLine(int argc, char* argv[]) {
+
+    //// Define the main command line object //////////////////////////////////////////////////////////////////////
+    TCLAP::CmdLine cmd("Convert a text graph file to a binary graph snapshot, optionally rebuilt for mining, that the"
+                           " benchmarks can load without parsing it again",
+                       ' ',         // Character used to separate the argument flag/name from the value
+                       "1",         // Version number to be displayed by the --version switch
+                       false);      // Whether or not to create the automatic --help and --version switches
+
+    std::vector<std::string> outlinksSortingValues;
+    outlinksSortingValues.push_back("NONE");
+    outlinksSortingValues.push_back("ID");
+    outlinksSortingValues.push_back("FREQUENCY");
+    TCLAP::ValuesConstraint<std::string> outlinksSortingConstraint(outlinksSortingValues);
+    TCLAP::ValueArg<std::string> outlinksSortingArg(
+        "r",
+        "outlinks-sorting",
+        "Rebuild the graph for mining before writing it, sorting the adjacency lists as in generateComplexes;"
+            " NONE writes it as read. Defaults to ID.",
+        false,
+        "ID",
+        &outlinksSortingConstraint,
+        cmd);
+    TCLAP::ValueArg<unsigned int> threadsArg(
+        "t",
+        "threads",
+        "Number of threads used to parse the text graph file and to rebuild it for mining. Defaults to 1.",
+        false,
+        1,
+        "THREADS",
+        cmd);
+
+    TCLAP::UnlabeledValueArg<std::string> graphFileNameArg(
+        "GRAPH_FILE",
+        "Path to an input text file with a graph, in the format accepted by the Graph constructor.",
+        true,
+        "",
+        "GRAPH_FILE",
+        cmd);
+    TCLAP::UnlabeledValueArg<std::string> snapshotFileNameArg(
+        "SNAPSHOT_FILE",
+        "Path to the output graph snapshot file.",
+        true,
+        "",
+        "SNAPSHOT_FILE",
+        cmd);
+
+    //// Parse the argv array /////////////////////////////////////////////////////////////////////////////////////
+    cmd.parse(argc, argv);
+
+    // Extra validation checks
+    if (graphFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", graphFileNameArg.longID());
+    if (snapshotFileNameArg.getValue().empty())
+        throw TCLAP::CmdLineParseException("Empty argument!", snapshotFileNameArg.longID());
+    if (threadsArg.getValue() == 0)
+        throw TCLAP::CmdLineParseException("At least one thread is required", threadsArg.longID());
+
+    //// Get the value parsed by each argument ////////////////////////////////////////////////////////////////////
+    CmdLineArgs args;
+
+    args.graphFileName    =    graphFileNameArg.getValue();
+    args.snapshotFileName = snapshotFileNameArg.getValue();
+    args.outlinksSorting  =  outlinksSortingArg.getValue();
+    args.threads          =          threadsArg.getValue();
+
+    return args;
+}